@@ -17,23 +17,12 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "SG90_pid.h"
 
 /****************************************************************************************
  * DATA TYPES
  */
 
-/*
- * Global pointer for the message template
- */
-typedef struct {
-    /* Pointer tomessage buffer */
-    char *data;
-    /* Message size */
-    size_t size;
-    /* Flag to signal that the message is ready to be sendt trough UART TX Bufffer */
-    bool ready;
-} DynamicBuffer;
-
 /*
  * Baud rate option array: [Baud Rate 0, Baud Rate 1]
  */
@@ -46,6 +35,15 @@ const uint8_t COM_UART_BROption[2] = {BR_SET_0, BR_SET_1};
  */
 #define BR_MSET 0x9200
 
+/*
+ * Dump baud rate option array (highest configured baud): BRClk = SMClk (1 MHz) and baudrate of 115200bps
+ *  - N = 1000000 / 115200 =~ 8.68 => OS16 = 0; UCBRx = 8; Frac(N) = 0.68 => UCBRSx = 0xD6
+ */
+#define BR_DUMP_SET_0 0x08
+#define BR_DUMP_SET_1 0x00
+#define BR_DUMP_MSET 0xD600
+const uint8_t COM_UART_BRDumpOption[2] = {BR_DUMP_SET_0, BR_DUMP_SET_1};
+
 /*
  * TB0_Divider_CCR
  */
@@ -59,6 +57,10 @@ const uint8_t COM_UART_BROption[2] = {BR_SET_0, BR_SET_1};
 #elif TB0_DELAY_SECONDS == 4
     #define TB0_CCR0_DIV 8192u
 #endif
+/* Runtime telemetry rate (Hz): TB0CCR0 = ACLK / rate; upper limit is the PWM rate (50 Hz) */
+#define TB0_ACLK_HZ 32768u
+#define TLM_RATE_MIN_HZ 1u
+#define TLM_RATE_MAX_HZ 50u
 /*
  * TB1_Divider_CCR
  */
@@ -70,20 +72,194 @@ const uint8_t COM_UART_BROption[2] = {BR_SET_0, BR_SET_1};
 
 /* 0° -> 1.5 ms [IDEAL: 1500ms --> REAL: 1750ms]*/
 #define SG90_0DEG 1750u
-/* 90° -> 2 ms [IDEAL: 2000ms --> REAL: 2750ms]*/
-#define SG90_P90DEG 2750u
-/* -90° -> 1 ms [IDEAL: 1000ms --> REAL: 730ms]*/
-#define SG90_N90DEG 730u
 /* 1° -> ms => */
 #define SG90_1DEG 11u
-/* Calib tolerances */
-#define SG90_45DEG_CALTOL 500
-#define SG90_30DEG_CALTOL 200
+/* Calib sweep angles (degrees, both directions) */
+#define SG90_CALIB_FIRST_DEG 45u
+#define SG90_CALIB_SECOND_DEG 30u
+
+/*
+ * Servo model descriptors (compare counts @ SMCLK 1 MHz -> 1 count = 1 us)
+ *  - NEUTRAL: pulse at 0°
+ *  - PER_DEG_Q8: pulse change per degree, Q8
+ *  - MIN / MAX: pulse limits
+ *  - MAX_SLEW: max pulse change per PWM period
+ *  - PERIOD: PWM period
+ * Commands use the SG90 encoding: 0..90 -> 0°..+90°, 91..180 -> -1°..-90°
+ */
+
+/* SG90: calibrated values of this board */
+#define SERVO_SG90_NEUTRAL SG90_0DEG
+#define SERVO_SG90_PER_DEG_Q8 (SG90_1DEG * 256u)
+#define SERVO_SG90_MIN (SG90_0DEG - 90u * SG90_1DEG)
+#define SERVO_SG90_MAX (SG90_0DEG + 90u * SG90_1DEG)
+/* 0.1 s / 60° -> 12° per period */
+#define SERVO_SG90_MAX_SLEW (12u * SG90_1DEG)
+#define SERVO_SG90_PERIOD 20000u
+
+/* MG996R: 1.5 ms +/- 1 ms over +/-90° */
+#define SERVO_MG996R_NEUTRAL 1500u
+#define SERVO_MG996R_PER_DEG_Q8 2844u
+#define SERVO_MG996R_MIN 500u
+#define SERVO_MG996R_MAX 2500u
+/* 0.17 s / 60° -> 7° per period */
+#define SERVO_MG996R_MAX_SLEW 78u
+#define SERVO_MG996R_PERIOD 20000u
+
+/* Digital servo (standard range): 1.5 ms +/- 0.5 ms over +/-90° */
+#define SERVO_DIGITAL_NEUTRAL 1500u
+#define SERVO_DIGITAL_PER_DEG_Q8 1422u
+#define SERVO_DIGITAL_MIN 1000u
+#define SERVO_DIGITAL_MAX 2000u
+/* 0.08 s / 60° -> 15° per period */
+#define SERVO_DIGITAL_MAX_SLEW 83u
+#define SERVO_DIGITAL_PERIOD 20000u
+
+/* Descriptor field access: SERVO_PARAM(SG90, NEUTRAL) -> SERVO_SG90_NEUTRAL */
+#define SERVO_PARAM_(model, field) SERVO_##model##_##field
+#define SERVO_PARAM(model, field) SERVO_PARAM_(model, field)
+
+/*
+ * Servo channels on Timer B1: CH0 -> TB1.1 (P2.0), CH1 -> TB1.2 (P2.1)
+ */
+#define SERVO_NR_OF_CHANNELS 2u
+#define SERVO_CH0 0u
+#define SERVO_CH1 1u
+/* Model of each channel (build time) */
+#define SERVO_CH0_MODEL SG90
+#define SERVO_CH1_MODEL SG90
+
+/* Channels share TB1CCR0 */
+#if SERVO_PARAM(SERVO_CH0_MODEL, PERIOD) != TB1_CCR0_DIV || SERVO_PARAM(SERVO_CH1_MODEL, PERIOD) != TB1_CCR0_DIV
+    #error "Servo models on Timer B1 must use the TB1_CCR0_DIV PWM period"
+#endif
+
+/*
+ * Angle -> compare value lookup tables, generated at build time from the model descriptor
+ */
+#define SERVO_CMD_MAX_DEG 180u
+#define SERVO_CLAMP(model, p) (((p) < SERVO_PARAM(model, MIN)) ? SERVO_PARAM(model, MIN) : \
+                               (((p) > SERVO_PARAM(model, MAX)) ? SERVO_PARAM(model, MAX) : (p)))
+#define SERVO_LUT_PULSE(model, d) \
+    (uint16_t)(((d) <= 90u) ? \
+        SERVO_CLAMP(model, SERVO_PARAM(model, NEUTRAL) + (((uint32_t)(d) * SERVO_PARAM(model, PER_DEG_Q8)) >> 8)) : \
+        SERVO_CLAMP(model, SERVO_PARAM(model, NEUTRAL) - (((uint32_t)((d) - 90u) * SERVO_PARAM(model, PER_DEG_Q8)) >> 8)))
+#define SERVO_LUT_REP10(model, b) \
+    SERVO_LUT_PULSE(model, (b) + 0u), SERVO_LUT_PULSE(model, (b) + 1u), SERVO_LUT_PULSE(model, (b) + 2u), \
+    SERVO_LUT_PULSE(model, (b) + 3u), SERVO_LUT_PULSE(model, (b) + 4u), SERVO_LUT_PULSE(model, (b) + 5u), \
+    SERVO_LUT_PULSE(model, (b) + 6u), SERVO_LUT_PULSE(model, (b) + 7u), SERVO_LUT_PULSE(model, (b) + 8u), \
+    SERVO_LUT_PULSE(model, (b) + 9u)
+#define SERVO_LUT_ENTRIES(model) \
+    SERVO_LUT_REP10(model, 0u),   SERVO_LUT_REP10(model, 10u),  SERVO_LUT_REP10(model, 20u),  \
+    SERVO_LUT_REP10(model, 30u),  SERVO_LUT_REP10(model, 40u),  SERVO_LUT_REP10(model, 50u),  \
+    SERVO_LUT_REP10(model, 60u),  SERVO_LUT_REP10(model, 70u),  SERVO_LUT_REP10(model, 80u),  \
+    SERVO_LUT_REP10(model, 90u),  SERVO_LUT_REP10(model, 100u), SERVO_LUT_REP10(model, 110u), \
+    SERVO_LUT_REP10(model, 120u), SERVO_LUT_REP10(model, 130u), SERVO_LUT_REP10(model, 140u), \
+    SERVO_LUT_REP10(model, 150u), SERVO_LUT_REP10(model, 160u), SERVO_LUT_REP10(model, 170u), \
+    SERVO_LUT_PULSE(model, 180u)
+
+const uint16_t SERVO_LutCh0[SERVO_CMD_MAX_DEG + 1u] = { SERVO_LUT_ENTRIES(SERVO_CH0_MODEL) };
+const uint16_t SERVO_LutCh1[SERVO_CMD_MAX_DEG + 1u] = { SERVO_LUT_ENTRIES(SERVO_CH1_MODEL) };
+const uint16_t * const SERVO_Lut[SERVO_NR_OF_CHANNELS] = {SERVO_LutCh0, SERVO_LutCh1};
+/* Per channel slew limit */
+const uint16_t SERVO_MaxSlew[SERVO_NR_OF_CHANNELS] = {SERVO_PARAM(SERVO_CH0_MODEL, MAX_SLEW),
+                                                      SERVO_PARAM(SERVO_CH1_MODEL, MAX_SLEW)};
+/* Per channel pulse limits */
+const uint16_t SERVO_MinCCR[SERVO_NR_OF_CHANNELS] = {SERVO_PARAM(SERVO_CH0_MODEL, MIN),
+                                                     SERVO_PARAM(SERVO_CH1_MODEL, MIN)};
+const uint16_t SERVO_MaxCCR[SERVO_NR_OF_CHANNELS] = {SERVO_PARAM(SERVO_CH0_MODEL, MAX),
+                                                     SERVO_PARAM(SERVO_CH1_MODEL, MAX)};
+
+/*
+ * Setpoint smoother: host setpoints are timestamped (TB1 ticks) when committed and the output is
+ * interpolated at the PWM rate over the last host interval, then extrapolated with the host rate for a
+ * bounded horizon; if no new setpoint arrives it glides back to the last one.
+ * 0u -> step to each new setpoint; 1u -> smoothing
+ */
+#define SERVO_SMOOTHING 1u
+/* Longest host interval used for interpolation (TB1 ticks): 10 -> 5 Hz host rate */
+#define SMOOTH_MAX_INTERVAL 10u
+/* Extrapolation horizon (TB1 ticks), 0 -> no extrapolation */
+#define SMOOTH_EXTRAP_MAX_TICKS 5u
+
+typedef struct {
+    /* Output position, compare counts Q8 */
+    int32_t posQ8;
+    /* Step per tick towards the target, Q8 */
+    int32_t velQ8;
+    /* Host setpoint rate per tick, Q8 */
+    int32_t hostVelQ8;
+    /* Last host setpoint */
+    uint16_t target;
+    /* Ticks left for interpolation / extrapolation */
+    uint8_t interpLeft;
+    uint8_t extrapLeft;
+} SMOOTH_State;
+
+SMOOTH_State SMOOTH_Ch[SERVO_NR_OF_CHANNELS];
+/* TB1 counter at the last host setpoint; no recent setpoint -> no host rate */
+uint16_t SMOOTH_LastCmdTick;
+bool SMOOTH_HaveCmd;
 
 /* SG90 degree motion + null terminator */
 volatile char UART_RX_Buff[4];
 volatile uint8_t nrOfDegrees;
-volatile uint8_t setNrOfDegrees;
+volatile uint8_t setNrOfDegrees[SERVO_NR_OF_CHANNELS];
+
+/*
+ * Group setpoint command: "G<seq>,<deg CH0>,<deg CH1>" + terminator
+ */
+#define UART_CMD_NONE 0u
+/* Rejected frame: bytes are dropped up to the terminator, nothing is committed */
+#define UART_CMD_DISCARD 0xFFu
+#define UART_CMD_GROUP 'G'
+#define UART_CMD_DUMP 'D'
+#define UART_CMD_RATE 'R'
+#define UART_CMD_MODE 'M'
+#define UART_CMD_WDT 'W'
+#define UART_CMD_STATS 'S'
+#define UART_CMD_CAPTURE 'C'
+#define UART_CMD_REPLAY 'P'
+#define UART_CMD_TIMEOUT 'T'
+#define UART_CMD_BENCH 'B'
+#define UART_CMD_IS_ID(c) ((c) == UART_CMD_GROUP || (c) == UART_CMD_DUMP || \
+                           (c) == UART_CMD_RATE || (c) == UART_CMD_MODE || (c) == UART_CMD_WDT || \
+                           (c) == UART_CMD_STATS || (c) == UART_CMD_CAPTURE || (c) == UART_CMD_REPLAY || \
+                           (c) == UART_CMD_TIMEOUT || (c) == UART_CMD_BENCH)
+#define UART_CMD_FIELD_SEP ','
+/* Max value accepted for a command field */
+#define UART_CMD_FIELD_MAX 999u
+/* Group command fields: sequence ID + one angle per channel */
+#define UART_GROUP_NR_OF_FIELDS (1u + SERVO_NR_OF_CHANNELS)
+/* Sequence ID is echoed as 8 bit: larger values are rejected, not wrapped */
+#define UART_GROUP_SEQ_MAX 255u
+
+/* Command parser state (main loop context, fed from the RX queue) */
+volatile uint8_t UART_CmdId;
+volatile uint8_t UART_CmdFieldIdx;
+volatile uint16_t UART_CmdFields[UART_GROUP_NR_OF_FIELDS];
+/* Sequence ID of the last accepted group command */
+volatile uint8_t UART_GroupSeqId;
+/* Nr. of accepted setpoint commands (plain angle or group), marks a new host sample for the smoother */
+volatile uint8_t UART_SetpointCmdCnt;
+
+/*
+ * Shadow table for the compare registers, committed by TB1 CCR0 ISR on the PWM period boundary
+ */
+volatile uint16_t SERVO_ShadowCCR[SERVO_NR_OF_CHANNELS];
+volatile uint8_t SERVO_ShadowSeqId;
+volatile uint8_t SERVO_ShadowCmdCnt;
+/* Setpoint command count of the committed group */
+volatile uint8_t SERVO_CommittedCmdCnt;
+volatile bool SERVO_ShadowPending;
+/* CH0 compare register is driven by SG90_Calibration, the TB1 ISR leaves it alone */
+volatile bool SG90_CalibActive;
+/* Committed compare value of each channel (open loop target) */
+volatile uint16_t SERVO_TargetCCR[SERVO_NR_OF_CHANNELS];
+/* Slew limited compare value of each channel */
+volatile uint16_t SERVO_OutCCR[SERVO_NR_OF_CHANNELS];
+/* Sequence ID of the group currently driven on the compare registers */
+volatile uint8_t SERVO_CommittedSeqId;
 
 /*
  * UART settings
@@ -98,46 +274,367 @@ volatile uint8_t setNrOfDegrees;
 #define SG90_LONG_CALIB 0u
 #define SG90_SHRT_CALIB 1u
 
+/*
+ * SG90 closed loop position control (CH0): ADC feedback + fixed-point PID at the control rate
+ * 0u -> open loop (compare value only); 1u -> closed loop
+ */
+#define SG90_CLOSED_LOOP 0u
+
+/*
+ * Position feedback: potentiometer on P1.5 (A5), conversion triggered by TB1.1 rising edge (PWM period start)
+ * ADC counts (12 bit) read with the CH0 servo held at -90° / +90° (model MIN / MAX pulse)
+ */
+#define FB_ADC_N90DEG 410
+#define FB_ADC_P90DEG 3686
+/* Compare counts per ADC count, Q12 */
+#define FB_CCR_PER_ADC_Q12 ((int32_t)(SERVO_PARAM(SERVO_CH0_MODEL, MAX) - SERVO_PARAM(SERVO_CH0_MODEL, MIN)) * 4096 / \
+                            (FB_ADC_P90DEG - FB_ADC_N90DEG))
+
+/* PID gains, limits and PID_step: SG90_pid.h */
+/* Latest feedback sample (ADC ISR); valid once a conversion has completed */
+volatile uint16_t ADC_PosRaw;
+volatile bool ADC_PosValid;
+/* CH0 position loop; seeded from the feedback on the first step after calibration */
+PID_State SG90_PosPid = {PID_KP_Q8, PID_KI_Q8, PID_KD_Q8, 0, 0};
+bool SG90_PidSeeded;
+
 /*
  * Timer B0 counter
  */
 volatile long tb0_cnt;
 
+/*
+ * Timer B1 counter (PWM periods, control rate)
+ */
+volatile uint16_t tb1_cnt;
+
+/*
+ * FRAM telemetry log: circular buffer of compact samples recorded at the control rate
+ */
+#define TLOG_NR_OF_SAMPLES 512u
+/* Samples per dump block */
+#define TLOG_DUMP_BLOCK 32u
+/* Dump frame markers */
+#define TLOG_DUMP_BLOCK_ID 'B'
+/* Idle time at the dump baud before the header, lets the host follow the announce line and switch */
+#define TLOG_DUMP_GUARD_MS 100u
+/* Sample flags */
+#define TLOG_FLAG_CAPTURE 0x01u
+#define TLOG_FLAG_REPLAY 0x02u
+
+typedef struct {
+    /* TB1 counter at record time */
+    uint16_t tick;
+    /* Compare value driven on each channel */
+    uint16_t ccr[SERVO_NR_OF_CHANNELS];
+    /* Setpoint of each channel */
+    uint8_t deg[SERVO_NR_OF_CHANNELS];
+    /* Committed group sequence ID */
+    uint8_t seq;
+    /* TLOG_FLAG_*: capture / replay running in this period (trace alignment on the host) */
+    uint8_t flags;
+    /* Position feedback, raw ADC counts */
+    uint16_t fb;
+} TLOG_Sample;
+
+/* Log storage is placed in FRAM (.TI.persistent, outside the write protected program area) */
+#pragma PERSISTENT(TLOG_Buff)
+TLOG_Sample TLOG_Buff[TLOG_NR_OF_SAMPLES] = {0};
+/* Next write index */
+#pragma PERSISTENT(TLOG_Head)
+uint16_t TLOG_Head = 0;
+/* Nr. of valid samples */
+#pragma PERSISTENT(TLOG_Count)
+uint16_t TLOG_Count = 0;
+
+/*
+ * Watchdog supervision: periodic tasks check in, the TB1 ISR services the WDT only if every task met its deadline
+ */
+#define WDT_TASK_MAIN 0u
+#define WDT_TASK_TLM 1u
+#define WDT_TASK_CTRL 2u
+#define WDT_NR_OF_TASKS 3u
+/* Supervision window (TB1 ticks, 20 ms each) */
+#define WDT_SUPERVISE_TICKS 10u
+/* Deadlines (TB1 ticks) */
+#define WDT_DEADLINE_MAIN 25u
+#define WDT_DEADLINE_MARGIN 5u
+/* Watchdog mode; ACLK (32768 Hz); 2^15 => 1 s timeout; clear counter */
+#define WDT_KICK (WDTPW | WDTHOLD_0 | WDTSSEL__ACLK | WDTTMSEL_0 | WDTCNTCL_1 | WDTIS_4)
+
+typedef struct {
+    /* Nr. of boots and WDT timeouts */
+    uint16_t resetCount;
+    uint16_t wdtResetCount;
+    /* SYSRSTIV of the last boot */
+    uint16_t lastCause;
+    /* TB1 counter and late task mask at the last supervision */
+    uint16_t lastTick;
+    uint16_t lateMask;
+    /* Missed deadlines per task */
+    uint16_t missed[WDT_NR_OF_TASKS];
+} WDT_Info;
+
+/* Kept in FRAM: survives the WDT reset */
+#pragma PERSISTENT(WDT_ResetInfo)
+WDT_Info WDT_ResetInfo = {0};
+/* State of the previous run, copied at boot before supervision overwrites WDT_ResetInfo */
+#pragma PERSISTENT(WDT_PrevRun)
+WDT_Info WDT_PrevRun = {0};
+/* Last check-in (TB1 counter) and deadline of each task */
+volatile uint16_t WDT_TaskLastTick[WDT_NR_OF_TASKS];
+volatile uint16_t WDT_TaskDeadline[WDT_NR_OF_TASKS];
+/* Missed deadlines since boot */
+volatile uint16_t WDT_Missed[WDT_NR_OF_TASKS];
+/* Late tasks in the current window */
+volatile uint8_t WDT_LateMask;
+/* Supervised tasks; the main task joins when the main loop starts (calibration blocks for seconds) */
+volatile uint8_t WDT_ArmedMask;
+/* Report requested by command */
+volatile bool WDT_ReportRequest;
+
+/*
+ * Benchmark probes on the hot paths: TB2 runs free on SMCLK (= MCLK, 1 MHz) -> 1 count = 1 CPU cycle = 1 us.
+ * Main loop probes include the time spent in interrupts. Resource report (stack high-water mark, section
+ * sizes from the linker) is always available; "B" prints both, probe counters restart after each report.
+ * 0u -> probes compiled out; 1u -> probes on. Bench builds set it from the command line (--define=BENCH_ENABLE=1u)
+ */
+#ifndef BENCH_ENABLE
+#define BENCH_ENABLE 0u
+#endif
+#define BENCH_FORMAT 0u
+#define BENCH_PARSE 1u
+#define BENCH_SET_ANGLE 2u
+#define BENCH_TX_ISR 3u
+#define BENCH_CTRL_ISR 4u
+#define BENCH_COMMAND 5u
+#define BENCH_NR_OF_PROBES 6u
+/* Report: one line per probe + resource line */
+#define BENCH_REPORT_NR_OF_LINES (BENCH_NR_OF_PROBES + 1u)
+#define BENCH_CYCLES_PER_S 1000000ul
+/* Report window is measured in PWM periods */
+#define BENCH_TICKS_PER_S (BENCH_CYCLES_PER_S / TB1_CCR0_DIV)
+/*
+ * Budgets (cycles): a probe whose worst case is above budget is flagged with '!' in the report
+ *  - FORMAT: half of the shortest telemetry period (50 Hz)
+ *  - PARSE: one byte time @ 9600bps, so the parser keeps up with the line
+ *  - SET_ANGLE: runs with interrupts disabled
+ *  - TX_ISR: one byte time @ 115200bps (log dump)
+ *  - CTRL_ISR: 10% CPU load at the PWM rate (compare writes are latched, the hard limit is the period)
+ *  - COMMAND: longest group frame ("G255,180,180" + terminator, 13 bytes) within its own line time @ 9600bps
+ */
+#define BENCH_BUDGET_FORMAT 10000u
+#define BENCH_BUDGET_PARSE 1041u
+#define BENCH_BUDGET_SET_ANGLE 100u
+#define BENCH_BUDGET_TX_ISR 86u
+#define BENCH_BUDGET_CTRL_ISR (TB1_CCR0_DIV / 10u)
+#define BENCH_BUDGET_COMMAND (13u * BENCH_BUDGET_PARSE)
+/* Stack: flagged above this share of the .stack section */
+#define BENCH_STACK_BUDGET_PCT 75u
+#define BENCH_STACK_PAINT 0xA5A5u
+
+#if BENCH_ENABLE == 1
+#define BENCH_START(probe) uint16_t bench_t0_##probe = TB2R
+#define BENCH_STOP(probe) BENCH_Record((probe), (uint16_t)(TB2R - bench_t0_##probe))
+#else
+#define BENCH_START(probe)
+#define BENCH_STOP(probe)
+#endif
+
+typedef struct {
+    /* Nr. of samples (saturates, total stops with it) */
+    uint16_t count;
+    /* Best / worst case (cycles) */
+    uint16_t min;
+    uint16_t max;
+    /* Sum of all samples (cycles) */
+    uint32_t total;
+    /* TB1 counter at the start of the window */
+    uint16_t startTick;
+} BENCH_Probe;
+
+volatile BENCH_Probe BENCH_Probes[BENCH_NR_OF_PROBES];
+const char *const BENCH_ProbeName[BENCH_NR_OF_PROBES] = {"fmt", "rx", "angle", "tx isr", "ctrl isr", "cmd"};
+const uint16_t BENCH_Budget[BENCH_NR_OF_PROBES] = {BENCH_BUDGET_FORMAT, BENCH_BUDGET_PARSE, BENCH_BUDGET_SET_ANGLE,
+                                                   BENCH_BUDGET_TX_ISR, BENCH_BUDGET_CTRL_ISR, BENCH_BUDGET_COMMAND};
+/* Cost of the TB2 reads themselves, subtracted from every sample */
+uint16_t BENCH_Overhead;
+/* Next report line; BENCH_REPORT_NR_OF_LINES -> no report pending */
+volatile uint8_t BENCH_ReportLine;
+
+/* Linker symbols: .stack bounds and section sizes (SIZE() in lnk_msp430fr2355.cmd; the address is the value) */
+extern uint16_t _stack;
+extern uint16_t __STACK_END;
+extern uint16_t ram_bss_size;
+extern uint16_t ram_data_size;
+extern uint16_t fram_text_size;
+extern uint16_t fram_isr_size;
+extern uint16_t fram_const_size;
+extern uint16_t fram_persistent_size;
+
+/*
+ * Serial traffic capture: timestamped RX/TX bytes in FRAM, replayed into the RX queue on command.
+ * Fixed size little endian records -> the dumped capture can be memory mapped on the host as an array.
+ * Filled once from the start, stops when full (a replay must start from the recorded start state):
+ * ~1000 command bytes RX only; TX telemetry fills it in a few seconds.
+ */
+#define SCAP_NR_OF_RECORDS 1024u
+/* Capture mask */
+#define SCAP_RX 1u
+#define SCAP_TX 2u
+/* Start state record: the first SCAP_NR_OF_STATE_FIELDS records of a capture, one field each, in this order */
+#define SCAP_STATE 4u
+#define SCAP_STATE_DEG0 0u
+#define SCAP_STATE_DEG1 1u
+#define SCAP_STATE_SEQ 2u
+#define SCAP_STATE_TLM_MODE 3u
+#define SCAP_STATE_TLM_RATE 4u
+#define SCAP_NR_OF_STATE_FIELDS 5u
+/* Replay speed: 1 = original timing, N = N times faster, 0 = as fast as the RX queue drains */
+#define SCAP_REPLAY_MAX_SPEED 50u
+
+typedef struct {
+    /* TB1 counter at capture time */
+    uint16_t tick;
+    /* SCAP_RX, SCAP_TX or SCAP_STATE */
+    uint8_t dir;
+    /* Byte on the wire, start state field */
+    uint8_t data;
+} SCAP_Record;
+
+#pragma PERSISTENT(SCAP_Buff)
+SCAP_Record SCAP_Buff[SCAP_NR_OF_RECORDS] = {0};
+#pragma PERSISTENT(SCAP_Head)
+uint16_t SCAP_Head = 0;
+#pragma PERSISTENT(SCAP_Count)
+uint16_t SCAP_Count = 0;
+/* Bytes not captured because the capture was full */
+#pragma PERSISTENT(SCAP_Lost)
+uint16_t SCAP_Lost = 0;
+
+/* Active capture mask (0 = off) */
+volatile uint8_t SCAP_Mask;
+/* Replay state (TB1 ISR context) */
+volatile bool SCAP_ReplayActive;
+/* Replayed bytes still in flight: set at start, cleared once the parser consumed the last one (main loop) */
+volatile bool SCAP_Replaying;
+volatile uint8_t SCAP_ReplaySpeed;
+volatile uint16_t SCAP_ReplayIdx;
+volatile uint16_t SCAP_ReplayLeft;
+volatile uint16_t SCAP_ReplayClock;
+volatile uint16_t SCAP_ReplayBaseTick;
+
+/* Dump regions */
+#define TLOG_REGION_SAMPLES 0u
+#define TLOG_REGION_CAPTURE 1u
+
+/* Dump requested by command */
+volatile bool TLOG_DumpRequest;
+volatile uint8_t TLOG_DumpRegion;
+/* Dump in progress: logging and periodic messages are paused */
+volatile bool TLOG_DumpActive;
+
 /*
  * Clock system frequency divider factor
  */
 #define CS_DF 487u
 
-/****************************************************************************************
- * END OF DATA TYPES
+/*
+ * Max length of the formatted status message (worst case full status line is 158 chars)
  */
+#define UART_MSG_MAX_LEN 160u
 
-/****************************************************************************************
- * FUNCTION PROTOTYPES
+/*
+ * UART TX queue, drained by the eUSCI A1 TX interrupt (256 entries -> uint8_t indexes wrap by themselves)
  */
+#define UART_TX_QUEUE_SIZE 256u
+volatile char UART_TxQueue[UART_TX_QUEUE_SIZE];
+volatile uint8_t UART_TxHead;
+volatile uint8_t UART_TxTail;
 
-/*********************************_DYNAMIC_BUFFER_**************************************/
+/*
+ * UART RX queue, filled by the eUSCI A1 RX interrupt and parsed in the main loop (size: power of 2)
+ */
+#define UART_RX_QUEUE_SIZE 64u
+#define UART_RX_QUEUE_MASK (UART_RX_QUEUE_SIZE - 1u)
+volatile char UART_RxQueue[UART_RX_QUEUE_SIZE];
+volatile uint8_t UART_RxHead;
+volatile uint8_t UART_RxTail;
 
-/****************************************************************************************
- * Func name: allocateMessageBuffer
- * Descr: Prototype, set a dynamic message template size in the buffer.
- * @param size: The message string to be set as template size.
+/*
+ * RX idle timeout: a frame without terminator is closed after this many TB1 ticks (20 ms) without RX bytes.
+ * Keyboard input gets a longer gap for typing; 0 -> disabled. Runtime value: "T<ticks>"
+ */
+#if UART_HDL_KEYBOARD == 1
+#define UART_RX_TIMEOUT_TICKS 250u
+#else
+#define UART_RX_TIMEOUT_TICKS 5u
+#endif
+#define UART_RX_TIMEOUT_MAX 250u
+/* 0u -> drop the partial frame; 1u -> commit it as if the terminator had arrived */
+#define UART_RX_TIMEOUT_COMMIT 0u
+volatile uint8_t UART_RxTimeoutTicks;
+/* TB1 counter at the last RX byte */
+volatile uint16_t UART_RxLastTick;
+
+/*
+ * UART link health counters
+ */
+typedef struct {
+    /* eUSCI errors: overrun (UCOE), framing (UCFE); 8N1 link, parity is not checked (UCPEN = 0) */
+    uint16_t rxOverrun;
+    uint16_t rxFraming;
+    /* Bytes lost because the RX queue was full */
+    uint16_t rxQueueDrops;
+    /* Invalid characters and malformed command frames */
+    uint16_t parseRejects;
+    /* Partial frames closed by the RX idle timeout */
+    uint16_t rxTimeouts;
+    /* Messages dropped because the TX queue was full */
+    uint16_t txDrops;
+    /* RX queue high-water mark (bytes) */
+    uint8_t rxQueueHwm;
+} UART_LinkStats;
+
+volatile UART_LinkStats UART_Stats;
+/* Stats report requested by command */
+volatile bool UART_StatsRequest;
+
+/*
+ * Telemetry: full status line (keyframe) or delta line with changed fields only
  */
-void allocateMessageBuffer(size_t size);
+#define TLM_MODE_FULL 0u
+#define TLM_MODE_DELTA 1u
+/* Delta mode: full line every N telemetry ticks */
+#define TLM_KEYFRAME_PERIOD 20u
+
+typedef struct {
+    uint8_t deg[SERVO_NR_OF_CHANNELS];
+    uint8_t tmp;
+    uint8_t seq;
+    uint16_t ccr[SERVO_NR_OF_CHANNELS];
+    /* Sum of the link error counters */
+    uint16_t err;
+} TLM_Fields;
+
+/* Telemetry tick from TB0 */
+volatile bool TLM_Due;
+/* Current mode and rate */
+volatile uint8_t TLM_Mode;
+volatile uint8_t TLM_RateHz;
+/* Force a keyframe on the next tick (mode change, start-up) */
+volatile bool TLM_KeyframeRequest;
+/* Last transmitted field values */
+TLM_Fields TLM_LastSent;
+uint8_t TLM_FramesSinceKey;
 
 /****************************************************************************************
- * Func name: setMessageInBuffer
- * Descr: Prototype, set a dynamic message template.
- * @param message: The message string to be set as template.
+ * END OF DATA TYPES
  */
-void setMessageInBuffer(const char *message);
 
 /****************************************************************************************
- * Func name: freeMessageBuffer
- * Descr: Prototype, free the memory allocated for the message template.
- * @param: none
+ * FUNCTION PROTOTYPES
  */
-void freeMessageBuffer();
 
 /***********************************_CLOCK_SYSTEM_**************************************/
 
@@ -171,13 +668,49 @@ void ClockSystem_Callback(void(*fptr)(void));
 void UART_COM_ConfigureUart();
 
 /****************************************************************************************
- * Func name: UART_COM_TransmitMessage
- * Descr: Function prototype for UART_COM_TransmitMessage
- * @params: none; data read from message pointer
+ * Func name: UART_COM_enqueueTx
+ * Descr: Function prototype for UART_COM_enqueueTx. Queues a string for the TX interrupt; drops it if it does not fit
+ * @params: const char *data
+ *
+ *
+ */
+bool UART_COM_enqueueTx(const char *data);
+
+/****************************************************************************************
+ * Func name: UART_COM_pushRx
+ * Descr: Function prototype for UART_COM_pushRx. Puts one byte in the RX queue (ISR context)
+ * @params: char data
+ * @return: false if the queue is full
+ *
+ */
+bool UART_COM_pushRx(char data);
+
+/****************************************************************************************
+ * Func name: UART_COM_processRx
+ * Descr: Function prototype for UART_COM_processRx. Parses the bytes waiting in the RX queue
+ * @params: none
+ *
+ *
+ */
+void UART_COM_processRx(void);
+
+/****************************************************************************************
+ * Func name: UART_COM_flushFrame
+ * Descr: Function prototype for UART_COM_flushFrame. Drops a partial frame and resets the parser
+ * @params: none
+ *
+ *
+ */
+void UART_COM_flushFrame(void);
+
+/****************************************************************************************
+ * Func name: UART_COM_FormatStats
+ * Descr: Function prototype for UART_COM_FormatStats. Formats the link health counters
+ * @params: char *msg, size_t size
  *
  *
  */
-void UART_COM_TransmitMessage();
+void UART_COM_FormatStats(char *msg, size_t size);
 
 /****************************************************************************************
  * Func name: UART_COM_Callback
@@ -195,6 +728,86 @@ void UART_COM_Callback(void(*fptr)(void));
  */
 void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t digit);
 
+/****************************************************************************************
+ * Func name: UART_COM_handle_CmdChar
+ * Descr: Prototype for UART_COM_handle_CmdChar. Handles command id, separator and digits of a command frame
+ * @param: char received_char
+ */
+void UART_COM_handle_CmdChar(char received_char);
+
+/****************************************************************************************
+ * Func name: UART_COM_commitCmd
+ * Descr: Prototype for UART_COM_commitCmd. Validates and applies the command frame on terminator
+ * @param: none
+ */
+void UART_COM_commitCmd(void);
+
+/****************************************************************************************
+ * Func name: UART_COM_SetBaud
+ * Descr: Prototype for UART_COM_SetBaud. Switches eUSCI A1 between the default and the dump baud rate
+ * @param: bool dumpBaud
+ */
+void UART_COM_SetBaud(bool dumpBaud);
+
+/****************************************************************************************
+ * Func name: UART_COM_putChar
+ * Descr: Prototype for UART_COM_putChar. Blocking send of one byte trough UART TX Buffer
+ * @param: uint8_t data
+ */
+void UART_COM_putChar(uint8_t data);
+
+/***********************************_TELEMETRY_LOG_*************************************/
+
+/****************************************************************************************
+ * Func name: TLOG_Record
+ * Descr: Prototype for TLOG_Record. Records one sample in the FRAM circular log
+ * @param: none
+ */
+void TLOG_Record(void);
+
+/****************************************************************************************
+ * Func name: TLOG_Dump
+ * Descr: Prototype for TLOG_Dump. Streams an FRAM log region in binary blocks at the dump baud rate
+ * @param: uint8_t region
+ */
+void TLOG_Dump(uint8_t region);
+
+/****************************************************************************************
+ * Func name: SCAP_Capture
+ * Descr: Prototype for SCAP_Capture. Appends one byte to the FRAM serial capture (ISR context)
+ * @param: uint8_t dir, uint8_t data
+ */
+void SCAP_Capture(uint8_t dir, uint8_t data);
+
+/****************************************************************************************
+ * Func name: SCAP_SaveState
+ * Descr: Prototype for SCAP_SaveState. Starts an empty capture with the start state records
+ * @param: none
+ */
+void SCAP_SaveState(void);
+
+/****************************************************************************************
+ * Func name: SCAP_RestoreState
+ * Descr: Prototype for SCAP_RestoreState. Restores the start state recorded at the head of the capture
+ * @param: none
+ */
+void SCAP_RestoreState(void);
+
+/****************************************************************************************
+ * Func name: SCAP_StartReplay
+ * Descr: Prototype for SCAP_StartReplay. Stops capture, restores the start state and starts feeding the captured
+ *        RX bytes to the parser
+ * @param: uint8_t speed
+ */
+void SCAP_StartReplay(uint8_t speed);
+
+/****************************************************************************************
+ * Func name: SCAP_ReplayStep
+ * Descr: Prototype for SCAP_ReplayStep. Pushes the RX records due in this period into the RX queue (TB1 ISR context)
+ * @param: none
+ */
+void SCAP_ReplayStep(void);
+
 /*************************************_TIMER_B_*****************************************/
 
 /****************************************************************************************
@@ -215,6 +828,24 @@ void TB_ConfigureTimerB0();
  */
 void TB_ConfigureTimerB1();
 
+/****************************************************************************************
+ * Func name: TB_ConfigureTimerB2
+ * Descr: Prototype of TB_ConfigureTimerB2
+ * @params:
+ *
+ *
+ */
+void TB_ConfigureTimerB2();
+
+/****************************************************************************************
+ * Func name: TB_SetTelemetryRate
+ * Descr: Prototype of TB_SetTelemetryRate. Reprograms TB0 period at runtime
+ * @params: uint8_t rateHz
+ *
+ *
+ */
+void TB_SetTelemetryRate(uint8_t rateHz);
+
 /****************************************************************************************
  * Func name: TB_Callback
  * Descr: Prototype of TB_Callback Callback
@@ -224,6 +855,26 @@ void TB_ConfigureTimerB1();
  */
 void TB_Callback(void(*fptr)(void));
 
+/**************************************_ADC_*******************************************/
+
+/****************************************************************************************
+ * Func name: ADC_ConfigureADC
+ * Descr: Prototype of ADC_ConfigureADC
+ * @params: none
+ *
+ *
+ */
+void ADC_ConfigureADC();
+
+/****************************************************************************************
+ * Func name: ADC_Callback
+ * Descr: Prototype of ADC_Callback
+ * @params: fptr
+ *
+ *
+ */
+void ADC_Callback(void(*fptr)(void));
+
 /***********************************_WATCHDOG_TIMER_*************************************/
 
 /****************************************************************************************
@@ -244,21 +895,168 @@ void WDT_ConfigureWDT();
  */
 void WDT_Callback(void(*fptr)(void));
 
+/****************************************************************************************
+ * Func name: WDT_InitSupervisor
+ * Descr: Prototype of WDT_InitSupervisor. Latches the reset cause in FRAM and arms the task deadlines
+ * @params: none
+ *
+ *
+ */
+void WDT_InitSupervisor(void);
+
+/****************************************************************************************
+ * Func name: WDT_CheckIn
+ * Descr: Prototype of WDT_CheckIn. Marks a periodic task as alive
+ * @params: uint8_t task
+ *
+ *
+ */
+void WDT_CheckIn(uint8_t task);
+
+/****************************************************************************************
+ * Func name: WDT_Supervise
+ * Descr: Prototype of WDT_Supervise. Checks the deadlines and services the WDT (TB1 ISR context)
+ * @params: none
+ *
+ *
+ */
+void WDT_Supervise(void);
+
+/****************************************************************************************
+ * Func name: WDT_FormatReport
+ * Descr: Prototype of WDT_FormatReport. Formats reset cause, previous run state and current missed deadlines
+ * @params: char *msg, size_t size
+ *
+ *
+ */
+void WDT_FormatReport(char *msg, size_t size);
+
+/***************************************_BENCH_****************************************/
+
+/****************************************************************************************
+ * Func name: BENCH_PaintStack
+ * Descr: Prototype of BENCH_PaintStack. Fills the unused stack with a pattern for the high-water mark
+ * @params: none
+ *
+ *
+ */
+void BENCH_PaintStack(void);
+
+/****************************************************************************************
+ * Func name: BENCH_StackUsed
+ * Descr: Prototype of BENCH_StackUsed. Deepest stack use since boot
+ * @params: none
+ * @return: bytes
+ *
+ */
+uint16_t BENCH_StackUsed(void);
+
+/****************************************************************************************
+ * Func name: BENCH_AddSample
+ * Descr: Prototype of BENCH_AddSample. Adds one sample (net cycles) to a probe
+ * @params: uint8_t probe, uint16_t cycles
+ *
+ *
+ */
+void BENCH_AddSample(uint8_t probe, uint16_t cycles);
+
+/****************************************************************************************
+ * Func name: BENCH_Record
+ * Descr: Prototype of BENCH_Record. Adds one raw TB2 interval to a probe, less the probe overhead
+ * @params: uint8_t probe, uint16_t cycles
+ * @return: net cycles recorded
+ *
+ */
+uint16_t BENCH_Record(uint8_t probe, uint16_t cycles);
+
+/****************************************************************************************
+ * Func name: BENCH_ResetProbe
+ * Descr: Prototype of BENCH_ResetProbe. Restarts the statistics of a probe
+ * @params: uint8_t probe
+ *
+ *
+ */
+void BENCH_ResetProbe(uint8_t probe);
+
+/****************************************************************************************
+ * Func name: BENCH_FormatReport
+ * Descr: Prototype of BENCH_FormatReport. Formats one line of the benchmark / resource report
+ * @params: uint8_t line, char *msg, size_t size
+ * @return: message length, 0 if the line is not available
+ *
+ */
+size_t BENCH_FormatReport(uint8_t line, char *msg, size_t size);
+
 /***********************************_SERVO_CONTROL_*************************************/
 
 /****************************************************************************************
  * Func name: SG90_Calibration
- * Descr: Prototype for motor calibration.
- * @param: unsigned int calib_time, unsigned int sg90_firstAngle, unsigned int sg90_secondAngle
+ * Descr: Prototype for motor calibration. Pulses come from the CH0 model table, so they stay inside its limits.
+ * @param: unsigned int calib_time, unsigned int sg90_firstAngle, unsigned int sg90_secondAngle (degrees, 0..90)
  */
 void SG90_Calibration(unsigned int calib_time, unsigned int sg90_firstAngle, unsigned int sg90_secondAngle);
 
 /****************************************************************************************
  * Func name: SG90_setAngle
- * Descr: Definition for SG90_setAngle function. Sets the angle of the servo motor
- * @param: nrOfDegrees
+ * Descr: Prototype for SG90_setAngle function. Stages the angle of a servo channel in the shadow table
+ * @param: uint8_t channel, uint8_t nrOfDegrees
+ */
+void SG90_setAngle(uint8_t channel, uint8_t nrOfDegrees);
+
+/****************************************************************************************
+ * Func name: SERVO_StageGroup
+ * Descr: Prototype for SERVO_StageGroup. Stages the setpoints of all channels as one group for the next period
+ * @param: none
+ */
+void SERVO_StageGroup(void);
+
+/****************************************************************************************
+ * Func name: SERVO_slew
+ * Descr: Prototype for SERVO_slew. One PWM period step from the current towards the target compare value
+ * @param: uint16_t current, uint16_t target, uint16_t maxStep
+ * @return: next compare value
+ */
+uint16_t SERVO_slew(uint16_t current, uint16_t target, uint16_t maxStep);
+
+/****************************************************************************************
+ * Func name: SMOOTH_init
+ * Descr: Prototype for SMOOTH_init. Starts a channel smoother at rest on a compare value
+ * @param: uint8_t channel, uint16_t ccr
+ */
+void SMOOTH_init(uint8_t channel, uint16_t ccr);
+
+/****************************************************************************************
+ * Func name: SMOOTH_newSetpoint
+ * Descr: Prototype for SMOOTH_newSetpoint. Plans interpolation towards a new host setpoint
+ * @param: uint8_t channel, uint16_t target, uint16_t interval
+ */
+void SMOOTH_newSetpoint(uint8_t channel, uint16_t target, uint16_t interval);
+
+/****************************************************************************************
+ * Func name: SMOOTH_step
+ * Descr: Prototype for SMOOTH_step. One PWM period of the channel smoother
+ * @param: uint8_t channel
+ * @return: compare value
+ */
+uint16_t SMOOTH_step(uint8_t channel);
+
+/***********************************_TELEMETRY_*****************************************/
+
+/****************************************************************************************
+ * Func name: TLM_FormatMessage
+ * Descr: Prototype for TLM_FormatMessage. Formats a keyframe or a delta line
+ * @param: char *msg, size_t size
+ * @return: message length, 0 when there is nothing to send
+ */
+size_t TLM_FormatMessage(char *msg, size_t size);
+
+/****************************************************************************************
+ * Func name: SG90_closedLoopCCR
+ * Descr: Prototype for SG90_closedLoopCCR. Corrects the target compare value with the position feedback
+ * @param: uint16_t targetCCR, uint16_t adcRaw
+ * @return: compare value to drive
  */
-void SG90_setAngle(uint8_t nrOfDegrees);
+uint16_t SG90_closedLoopCCR(uint16_t targetCCR, uint16_t adcRaw);
 
 /****************************************************************************************
  * Func name: delay_ms
@@ -276,9 +1074,6 @@ void delay_ms(unsigned int ms);
  * SETTINGS
  */
 
-/* Init Dynamic Buffer */
-DynamicBuffer messageBuffer = {NULL, 0, false};
-
 /***************************************_MAIN_PROGRAM_**********************************/
 
 /****************************************************************************************
@@ -290,37 +1085,93 @@ DynamicBuffer messageBuffer = {NULL, 0, false};
  */
 int main(void)
 {
+    /* Temporary buffer for formatting the message (static: keeps it off the 160 byte stack) */
+    static char tempMessage[UART_MSG_MAX_LEN];
+
+    /* Mark the unused stack first, the high-water mark covers the whole run */
+    BENCH_PaintStack();
+
     /* Init program counter */
     tb0_cnt = 0;
     /* Init SG90 roation */
     nrOfDegrees = 0;
-    /* @descr: Watchdog timer config with 1 second interval interrupts */
+    /* Init command parser; channel setpoints start at 0° */
+    UART_CmdId = UART_CMD_NONE;
+    UART_CmdFieldIdx = 0;
+    UART_GroupSeqId = 0;
+    UART_SetpointCmdCnt = 0;
+    SERVO_CommittedSeqId = 0;
+    SERVO_CommittedCmdCnt = 0;
+    /* Init control rate counter and log dump flags (log content is kept in FRAM) */
+    tb1_cnt = 0;
+    TLOG_DumpRequest = false;
+    TLOG_DumpRegion = TLOG_REGION_SAMPLES;
+    TLOG_DumpActive = false;
+    /* Serial capture off, no replay (captured traffic is kept in FRAM) */
+    SCAP_Mask = 0;
+    SCAP_ReplayActive = false;
+    SCAP_Replaying = false;
+    /* Init UART queues, link counters and telemetry */
+    UART_TxHead = 0;
+    UART_TxTail = 0;
+    UART_RxHead = 0;
+    UART_RxTail = 0;
+    UART_RxTimeoutTicks = UART_RX_TIMEOUT_TICKS;
+    UART_RxLastTick = 0;
+    memset((void *)&UART_Stats, 0, sizeof(UART_Stats));
+    UART_StatsRequest = false;
+    BENCH_ReportLine = BENCH_REPORT_NR_OF_LINES;
+    TLM_Due = false;
+    TLM_Mode = TLM_MODE_FULL;
+    /* TB0_DELAY_SECONDS = 1/x seconds -> x Hz */
+    TLM_RateHz = TB0_DELAY_SECONDS;
+    TLM_KeyframeRequest = true;
+    TLM_FramesSinceKey = 0;
+    memset((void *)&setNrOfDegrees, 0, sizeof(setNrOfDegrees));
+    /* @descr: Watchdog timer config in watchdog mode with 1 second timeout */
     WDT_Callback(&WDT_ConfigureWDT);
+    /* @descr: Read reset cause into FRAM and arm task deadlines */
+    WDT_InitSupervisor();
     /* @descr: Config Clock System for AClk as source clock signal and MCLK = 16 Mhz and SMCLK = 1Mhz */
     ClockSystem_Callback(&ClockSystem_ConfigureClockSystem);
     /* @descr: Config Timer B0 for ACLK as source with 1 second interval interrupts */
     TB_Callback(&TB_ConfigureTimerB0);
-    /* @descr: Config Timer B1 for ACLK as source with 5% PWM Duty Cycle */
+    /* @descr: Config Timer B1 for SMCLK as source with 5% PWM Duty Cycle on CH0/CH1 and period boundary interrupts */
     TB_Callback(&TB_ConfigureTimerB1);
     /* @descr: Config UART using callback with settings: BRClk = AClk (32768 Hz) and BaudRate = 9600bps */
     UART_COM_Callback(&UART_COM_ConfigureUart);
+#if SG90_CLOSED_LOOP == 1
+    /* @descr: Config ADC on A5 with TB1.1 trigger for CH0 position feedback */
+    ADC_Callback(&ADC_ConfigureADC);
+#endif
+#if BENCH_ENABLE == 1
+    /* @descr: Config Timer B2 as free running cycle counter for the benchmark probes */
+    TB_Callback(&TB_ConfigureTimerB2);
+#endif
     /* P6.6 ---> signal light */
     P6DIR |= BIT6; P6OUT &=~BIT6;
     /* P1.0 --> signal light */
     P1DIR |= BIT0; P1OUT &=~BIT0;
-    /* P2.0 --> SG90 servo pin */
+    /* P2.0 --> SG90 servo pin CH0 */
     P2DIR |= BIT0; P2SEL1 &=~ BIT0; P2SEL0 |= BIT0;
+    /* P2.1 --> SG90 servo pin CH1 */
+    P2DIR |= BIT1; P2SEL1 &=~ BIT1; P2SEL0 |= BIT1;
     /* Disable high-impedance mode */
     PM5CTL0 &= ~LOCKLPM5;
+    /* Report reset cause and the state preserved from the last run */
+    WDT_FormatReport(tempMessage, sizeof(tempMessage));
+    UART_COM_enqueueTx(tempMessage);
     /* Enable maskable interrupts */
     __enable_interrupt();
-    /* Enable WDT interrupts */
-    SFRIE1 |= WDTIE;
     /* Enable eUSCI UART intterupts */
     UCA1IE |= UCRXIE;
 
     /* SG90 Calibration: x ms pace ; set -45°~45°; set -30°~30° */
-    SG90_Calibration(SG90_CALIB_TIME_MS, SG90_45DEG_CALTOL, SG90_30DEG_CALTOL);
+    SG90_Calibration(SG90_CALIB_TIME_MS, SG90_CALIB_FIRST_DEG, SG90_CALIB_SECOND_DEG);
+
+    /* Main task deadline starts with the main loop */
+    WDT_CheckIn(WDT_TASK_MAIN);
+    WDT_ArmedMask |= (1u << WDT_TASK_MAIN);
 
     /******************************************************************************
      * MAIN LOOP
@@ -328,26 +1179,69 @@ int main(void)
      */
     for(;;)
     {
-        /* Temporary buffer for formatting the message */
-        char tempMessage[100];
-        /* Format the message string including the counter value */
-        snprintf(tempMessage, sizeof(tempMessage),
-                 "Program counter [TB0]: %d ticks size: %d  [Servo rotation: %d deg. [temp val: %d]| PWM: %d ms] \n\r\r",
-                 (int)tb0_cnt,
-                 (uint8_t)messageBuffer.size,
-                 (uint8_t)setNrOfDegrees,
-                 (uint8_t)nrOfDegrees,
-                 (uint16_t)TB1CCR1);
-        /* Set message in buffer */
-        setMessageInBuffer(tempMessage);
+        /* Main loop is alive */
+        WDT_CheckIn(WDT_TASK_MAIN);
 
-        /* Control servo*/
-        SG90_setAngle(setNrOfDegrees);
-    }
-}
+        /* Parse received bytes */
+        UART_COM_processRx();
 
-/****************************************************************************************
- * ISR`s
+        /* Link stats report on request */
+        if (UART_StatsRequest)
+        {
+            UART_StatsRequest = false;
+            UART_COM_FormatStats(tempMessage, sizeof(tempMessage));
+            UART_COM_enqueueTx(tempMessage);
+        }
+
+        /* Watchdog report on request */
+        if (WDT_ReportRequest)
+        {
+            WDT_ReportRequest = false;
+            WDT_FormatReport(tempMessage, sizeof(tempMessage));
+            UART_COM_enqueueTx(tempMessage);
+        }
+
+        /* Benchmark / resource report: one line per pass, only into an empty TX queue so it never drops */
+        if (BENCH_ReportLine < BENCH_REPORT_NR_OF_LINES && UART_TxTail == UART_TxHead)
+        {
+            if (BENCH_FormatReport(BENCH_ReportLine, tempMessage, sizeof(tempMessage)) > 0)
+            {
+                UART_COM_enqueueTx(tempMessage);
+            }
+            BENCH_ReportLine++;
+        }
+
+        /* Dump the FRAM log on request */
+        if (TLOG_DumpRequest)
+        {
+            TLOG_Dump(TLOG_DumpRegion);
+            TLOG_DumpRequest = false;
+        }
+
+        /* Telemetry tick: format the message and hand it to the TX queue */
+        if (TLM_Due)
+        {
+            size_t len;
+
+            TLM_Due = false;
+            BENCH_START(BENCH_FORMAT);
+            len = TLM_FormatMessage(tempMessage, sizeof(tempMessage));
+            BENCH_STOP(BENCH_FORMAT);
+            if (len > 0)
+            {
+                UART_COM_enqueueTx(tempMessage);
+                /* Signal end of message sending */
+                P6OUT &= ~BIT6;
+            }
+        }
+
+        /* Control servo */
+        SERVO_StageGroup();
+    }
+}
+
+/****************************************************************************************
+ * ISR`s
  */
 
 /* UART 1 ISR   (USCI_A1_VECTOR) */
@@ -361,24 +1255,48 @@ int main(void)
  */
 __interrupt void USCI_A1_ISR(void)
 {
-  /* UART TX Buffer index */
-  static uint8_t buff_idx = 0;
+  /* eUSCI status; error flags are cleared by reading UCA1RXBUF */
+  uint16_t status;
   /* Received char */
   char received_char = '\0';
-  /* Number digit */
-  uint8_t digit = 0;
 
   switch(__even_in_range(UCA1IV,USCI_UART_UCTXCPTIFG))
   {
     case USCI_NONE: break;
-    /* Interrupts from RX */
+    /* Interrupts from RX: queue the byte, parsing runs in the main loop */
     case USCI_UART_UCRXIFG:
-        UART_COM_handle_UartRxBuff(buff_idx, received_char, digit);
+        status = UCA1STATW;
+        received_char = UCA1RXBUF;
+        /* Overrun: a previous byte was lost, this one is valid */
+        if (status & UCOE) UART_Stats.rxOverrun++;
+        /* Framing error: byte is corrupt, drop it */
+        if (status & UCFE)
+        {
+            UART_Stats.rxFraming++;
+            break;
+        }
+        if (SCAP_Mask & SCAP_RX) SCAP_Capture(SCAP_RX, (uint8_t)received_char);
+        UART_COM_pushRx(received_char);
         break;
 
     /* Interrupts from TX */
     case USCI_UART_UCTXIFG:
+    {
+        BENCH_START(BENCH_TX_ISR);
+        /* Send next queued byte; stop TX interrupts when the queue is empty */
+        if (UART_TxTail != UART_TxHead)
+        {
+            if (SCAP_Mask & SCAP_TX) SCAP_Capture(SCAP_TX, (uint8_t)UART_TxQueue[UART_TxTail]);
+            UCA1TXBUF = UART_TxQueue[UART_TxTail];
+            UART_TxTail++;
+        }
+        else
+        {
+            UCA1IE &= ~UCTXIE;
+        }
+        BENCH_STOP(BENCH_TX_ISR);
         break;
+    }
     case USCI_UART_UCSTTIFG: break;
     case USCI_UART_UCTXCPTIFG: break;
     default: break;
@@ -399,25 +1317,130 @@ __interrupt void Timer_B (void)
     /* Increase TB0 Counter as program counter */
     tb0_cnt++;
 
+    /* Telemetry task is alive */
+    WDT_CheckIn(WDT_TASK_TLM);
     /* Signal start of message sending */
     P6OUT ^= BIT6;
-    /* Check message ready flag */
-    if (messageBuffer.ready)
+    /* Signal telemetry tick; message is formatted in the main loop and sent by the TX interrupt */
+    TLM_Due = true;
+}
+
+/* TB1 ISR   (TIMER1_B0_VECTOR) */
+#pragma vector = TIMER1_B0_VECTOR
+/****************************************************************************************
+ * Func name: Timer_B1_ISR
+ * Descr: Implementation of Timer_B1_ISR. PWM period boundary: commits the shadow table to all compare registers
+ * @params: void
+ *
+ *
+ */
+__interrupt void Timer_B1_ISR(void)
+{
+    BENCH_START(BENCH_CTRL_ISR);
+
+    /* Increase TB1 Counter as control rate counter */
+    tb1_cnt++;
+
+    WDT_CheckIn(WDT_TASK_CTRL);
+
+#if SERVO_SMOOTHING == 1
+    /* Host silent for longer than a streaming interval: forget the last setpoint before the 16 bit tick delta wraps */
+    if (SMOOTH_HaveCmd && ((uint16_t)(tb1_cnt - SMOOTH_LastCmdTick) > SMOOTH_MAX_INTERVAL))
     {
-        /* Init UART_TX_BUFFER index */
-        int i = 0;
-        /* Send data until null ending in the debug message */
-        while (messageBuffer.data[i] != '\0')
+        SMOOTH_HaveCmd = false;
+    }
+#endif
+
+    /* Commit staged group; compare writes are latched (CLLD_1), every channel picks it up on the next period */
+    if (SERVO_ShadowPending)
+    {
+        SERVO_TargetCCR[SERVO_CH0] = SERVO_ShadowCCR[SERVO_CH0];
+        SERVO_TargetCCR[SERVO_CH1] = SERVO_ShadowCCR[SERVO_CH1];
+        SERVO_CommittedSeqId = SERVO_ShadowSeqId;
+        SERVO_ShadowPending = false;
+#if SERVO_SMOOTHING == 1
+        /* New host setpoint: timestamp it and plan the motion over the last host interval */
+        if (SERVO_ShadowCmdCnt != SERVO_CommittedCmdCnt)
         {
-            /* Wait for no interrupts from eUSCI A1 UART  */
-            while (!(UCA1IFG & UCTXIFG));
-            UCA1TXBUF = messageBuffer.data[i];
-            i++;
+            /* No recent setpoint: no interval, handled like a command after a long pause */
+            uint16_t interval = SMOOTH_HaveCmd ? (uint16_t)(tb1_cnt - SMOOTH_LastCmdTick) : 0xFFFFu;
+            SMOOTH_LastCmdTick = tb1_cnt;
+            SMOOTH_HaveCmd = true;
+            SMOOTH_newSetpoint(SERVO_CH0, SERVO_TargetCCR[SERVO_CH0], interval);
+            SMOOTH_newSetpoint(SERVO_CH1, SERVO_TargetCCR[SERVO_CH1], interval);
         }
-        /* Free message buffer and set the transmit flag to false */
-        freeMessageBuffer();
+#endif
+        SERVO_CommittedCmdCnt = SERVO_ShadowCmdCnt;
+    }
+#if SERVO_SMOOTHING == 1
+    /* Move each channel along the smoothed path, no faster than the model slew rate */
+    SERVO_OutCCR[SERVO_CH0] = SERVO_slew(SERVO_OutCCR[SERVO_CH0], SMOOTH_step(SERVO_CH0), SERVO_MaxSlew[SERVO_CH0]);
+    SERVO_OutCCR[SERVO_CH1] = SERVO_slew(SERVO_OutCCR[SERVO_CH1], SMOOTH_step(SERVO_CH1), SERVO_MaxSlew[SERVO_CH1]);
+#else
+    /* Move each channel towards its target at no more than the model slew rate */
+    SERVO_OutCCR[SERVO_CH0] = SERVO_slew(SERVO_OutCCR[SERVO_CH0], SERVO_TargetCCR[SERVO_CH0], SERVO_MaxSlew[SERVO_CH0]);
+    SERVO_OutCCR[SERVO_CH1] = SERVO_slew(SERVO_OutCCR[SERVO_CH1], SERVO_TargetCCR[SERVO_CH1], SERVO_MaxSlew[SERVO_CH1]);
+#endif
+    if (!SG90_CalibActive)
+    {
+#if SG90_CLOSED_LOOP == 1
+        /* CH0: setpoint + PID correction from the last feedback sample; open loop until the first conversion */
+        TB1CCR1 = ADC_PosValid ? SG90_closedLoopCCR(SERVO_OutCCR[SERVO_CH0], ADC_PosRaw) : SERVO_OutCCR[SERVO_CH0];
+#else
+        TB1CCR1 = SERVO_OutCCR[SERVO_CH0];
+#endif
+    }
+    TB1CCR2 = SERVO_OutCCR[SERVO_CH1];
+
+    /* Record the period in the FRAM log */
+    if (!TLOG_DumpActive)
+    {
+        TLOG_Record();
+    }
+
+    /* Feed captured traffic back to the parser */
+    if (SCAP_ReplayActive)
+    {
+        SCAP_ReplayStep();
+    }
+
+    /* Service the WDT only if every task is on time */
+    if ((tb1_cnt % WDT_SUPERVISE_TICKS) == 0u)
+    {
+        WDT_Supervise();
+    }
+
+    /* Deadline: the next period boundary must not have passed, or this period's values were never latched */
+    if (TB1CCTL0 & CCIFG)
+    {
+        WDT_Missed[WDT_TASK_CTRL]++;
+        WDT_LateMask |= (1u << WDT_TASK_CTRL);
+    }
+
+    BENCH_STOP(BENCH_CTRL_ISR);
+}
+
+/* ADC ISR   (ADC_VECTOR) */
+#pragma vector=ADC_VECTOR
+/****************************************************************************************
+ * Func name: ADC_ISR
+ * Descr: Implementation of ADC_ISR. Stores the position feedback sample
+ * @params: void
+ *
+ *
+ */
+__interrupt void ADC_ISR(void)
+{
+    switch(__even_in_range(ADCIV,ADCIV_ADCIFG))
+    {
+        case ADCIV_NONE: break;
+        /* Conversion done */
+        case ADCIV_ADCIFG:
+            ADC_PosRaw = ADCMEM0;
+            ADC_PosValid = true;
+            break;
+        default: break;
     }
-    __delay_cycles(10000);
 }
 
 /* WDT ISR   (WDT_VECTOR) */
@@ -431,7 +1454,7 @@ __interrupt void Timer_B (void)
  */
 __interrupt void WDT_ISR(void)
 {
-    /* Placeholder */
+    /* Placeholder: WDT runs in watchdog mode, expiry is a reset (see WDT_Supervise) */
 }
 
 /****************************************************************************************
@@ -478,6 +1501,18 @@ void TB_Callback(void(*fptr)(void))
     (*fptr)();
 }
 
+/****************************************************************************************
+ * Func name: ADC_Callback
+ * Descr: Implementation of ADC_Callback
+ * @params: fptr
+ *
+ *
+ */
+void ADC_Callback(void(*fptr)(void))
+{
+    (*fptr)();
+}
+
 /****************************************************************************************
  * Func name: WDT_Callback
  * Descr: Implementation of WDT_Callback
@@ -509,17 +1544,16 @@ void WDT_Callback(void(*fptr)(void))
 void WDT_ConfigureWDT()
 {
     /*
-    * Formula for WDT Timer ISR freq.:
-    * SMCLK --> t_clk = 1/f = 1/ 1.000.000  = 1 * 10^-6 = 1 ms
-    * Qx = t_int / t_clk  => t_int = Qx * t_clk
-    *  => 8.38 = Qx * t_clk
-    *  => Qx = 8.38 / t_clk
-    *  => Qx = 2 / 1* 10^-6 = 8.388 * 10^6 ~ 2^23
-    *  => Qx = 2^23 => WDTIS_2
+    * Formula for WDT timeout:
+    * ACLK --> t_clk = 1/f = 1/ 32768 = 30.5 * 10^-6 s
+    * Qx = t_int / t_clk
+    *  => Qx = 1 / 30.5 * 10^-6 = 32768 = 2^15
+    *  => Qx = 2^15 => WDTIS_4
+    * ACLK (REFO) keeps running if the DCO/FLL is misconfigured.
     */
 
-    /* WDT not STOP; SMCLK ; Interval ; ... ; WDT CLK Source */
-    WDTCTL = WDTPW | WDTHOLD_0 | WDTSSEL__SMCLK | WDTTMSEL_1 | WDTCNTCL_1 | WDTIS_2;
+    /* WDT not STOP; ACLK ; Watchdog ; Clear counter ; 1 s timeout */
+    WDTCTL = WDT_KICK;
 }
 
 /****************************************************************************************
@@ -542,6 +1576,26 @@ void TB_ConfigureTimerB0()
     TB0CTL = TBSSEL__ACLK | MC__UP;
 }
 
+/****************************************************************************************
+ * Func name: TB_SetTelemetryRate
+ * Descr: Implementation of TB_SetTelemetryRate. Reprograms TB0 period at runtime
+ * @params: uint8_t rateHz
+ *
+ *
+ */
+void TB_SetTelemetryRate(uint8_t rateHz)
+{
+    /* Trim rate to [1 Hz, PWM rate] */
+    if (rateHz < TLM_RATE_MIN_HZ) rateHz = TLM_RATE_MIN_HZ;
+    if (rateHz > TLM_RATE_MAX_HZ) rateHz = TLM_RATE_MAX_HZ;
+    TLM_RateHz = rateHz;
+    /* Telemetry deadline follows its period */
+    WDT_TaskDeadline[WDT_TASK_TLM] = (uint16_t)(TLM_RATE_MAX_HZ / rateHz) + WDT_DEADLINE_MARGIN;
+    /* New period; clear TBR so a shorter period never waits for a counter wrap */
+    TB0CCR0 = (uint16_t)(TB0_ACLK_HZ / rateHz);
+    TB0CTL |= TBCLR;
+}
+
 /****************************************************************************************
  * Func name: TB_ConfigureTimerB1
  * Descr: Implementation of TB_ConfigureTimerB1
@@ -552,17 +1606,98 @@ void TB_ConfigureTimerB0()
 void TB_ConfigureTimerB1()
 {
     /*
-     * TB1.1 --> PWM Control for SG90 Servomotor
+     * TB1.1 --> PWM Control for SG90 Servomotor CH0
+     * TB1.2 --> PWM Control for SG90 Servomotor CH1
+     * TB1.0 --> PWM period boundary for shadow table commit
      */
 
+    /* Start both channels at 0° */
+    SERVO_ShadowCCR[SERVO_CH0] = SERVO_LutCh0[0];
+    SERVO_ShadowCCR[SERVO_CH1] = SERVO_LutCh1[0];
+    SERVO_TargetCCR[SERVO_CH0] = SERVO_LutCh0[0];
+    SERVO_TargetCCR[SERVO_CH1] = SERVO_LutCh1[0];
+    SERVO_OutCCR[SERVO_CH0] = SERVO_LutCh0[0];
+    SERVO_OutCCR[SERVO_CH1] = SERVO_LutCh1[0];
+    SMOOTH_init(SERVO_CH0, SERVO_LutCh0[0]);
+    SMOOTH_init(SERVO_CH1, SERVO_LutCh1[0]);
+    SMOOTH_LastCmdTick = 0;
+    SMOOTH_HaveCmd = false;
+    SERVO_ShadowPending = false;
+    SG90_CalibActive = false;
+    SG90_PidSeeded = false;
+    /* Reset/set mode for CCR1 and CCR2; immediate load for the start values */
+    TB1CCTL1 = OUTMOD_7;
+    TB1CCTL2 = OUTMOD_7;
+    TB1CCR1 = SERVO_LutCh0[0];
+    TB1CCR2 = SERVO_LutCh1[0];
+    /* From now on compare writes take effect at TBR = 0: a pulse never sees a value written mid-period */
+    TB1CCTL1 |= CLLD_1;
+    TB1CCTL2 |= CLLD_1;
     /* Set PWM period to 20000 */
     TB1CCR0 = TB1_CCR0_DIV;
-    /* Reset/set mode for CCR1 */
-    TB1CCTL1 = OUTMOD_7;
+    /* TBCCR0 interrupt enabled */
+    TB1CCTL0 = CCIE;
     /* SMCLK, up mode, clear TBR */
     TB1CTL = TBSSEL_2 | MC_1 | TBCLR;
 }
 
+/****************************************************************************************
+ * Func name: TB_ConfigureTimerB2
+ * Descr: Implementation of TB_ConfigureTimerB2
+ * @params:
+ *
+ *
+ */
+void TB_ConfigureTimerB2()
+{
+    /*
+     * TB2 --> free running cycle counter for the benchmark probes, no interrupts
+     */
+    uint16_t t0;
+    uint8_t probe;
+
+    for (probe = 0; probe < BENCH_NR_OF_PROBES; probe++)
+    {
+        BENCH_ResetProbe(probe);
+    }
+    /* SMCLK, continuous mode, clear TBR */
+    TB2CTL = TBSSEL_2 | MC__CONTINUOUS | TBCLR;
+    /* Back to back reads: the cost of an empty probe */
+    t0 = TB2R;
+    BENCH_Overhead = (uint16_t)(TB2R - t0);
+}
+
+/****************************************************************************************
+ * Func name: ADC_ConfigureADC
+ * Descr: Implementation of ADC_ConfigureADC
+ * @params: none
+ *
+ *
+ */
+void ADC_ConfigureADC()
+{
+    /*
+     * A5 (P1.5) --> position feedback for SG90 CH0
+     * Trigger: TB1.1B (ADCSHS_1); OUTMOD_7 sets TB1.1 at the start of every PWM period,
+     * so one conversion is taken per control period without CPU involvement.
+     */
+    /* P1.5 analog function */
+    P1SEL0 |= BIT5; P1SEL1 |= BIT5;
+    /* 16 ADCCLK sample & hold; ADC on */
+    ADCCTL0 = ADCSHT_2 | ADCON;
+    /* Sampling timer; TB1.1 trigger; repeat single channel */
+    ADCCTL1 = ADCSHP | ADCSHS_1 | ADCCONSEQ_2;
+    /* 12 bit resolution */
+    ADCCTL2 = ADCRES_2;
+    /* Vref = AVCC; input A5 */
+    ADCMCTL0 = ADCINCH_5;
+    /* Conversion done interrupt; no sample yet */
+    ADC_PosValid = false;
+    ADCIE = ADCIE0;
+    /* Enable conversions (started by the trigger) */
+    ADCCTL0 |= ADCENC;
+}
+
 /****************************************************************************************
  * Func name: UART_COM_ConfigureUart
  * Descr: Implementation of UART_COM_ConfigureUart
@@ -598,6 +1733,8 @@ void UART_COM_ConfigureUart()
     UCA1BR1 = COM_UART_BROption[1];
     /* eUSCI_Ax Modulation Control Word Register */
     UCA1MCTLW = BR_MSET;
+    /* Erroneous bytes raise UCRXIFG too: the ISR reads them, which clears UCFE / UCOE for the next byte */
+    UCA1CTLW0 |= UCRXEIE;
     /* Initialize eUSCI */
     UCA1CTLW0 &= ~UCSWRST;
 }
@@ -645,93 +1782,20 @@ void ClockSystem_ConfigureClockSystem()
  * FUNCTION DEFINITIONS
  */
 
-/****************************************************************************************
- * Func name: allocateMessageBuffer
- * Descr: Set a dynamic message template size in the buffer.
- * @param size: The message string to be set as template size.
- */
-void allocateMessageBuffer(size_t size)
-{
-    /* Check if the data is allocated */
-    if(messageBuffer.data != NULL)
-    {
-        /* Clear buffer */
-        free(messageBuffer.data);
-        messageBuffer.data = NULL;
-    }
-    /* Allocate data dynamically */
-    messageBuffer.data = (char*)malloc(size);
-    /* Get the size if the memory is allocated */
-    if(messageBuffer.data != NULL)
-    {
-        messageBuffer.size = size;
-        messageBuffer.ready = false;
-    }
-    else
-    {
-        messageBuffer.size = 0;
-    }
-    /* For debug turn on/off led P1.0 to signal data allocation */
-    if (messageBuffer.data == NULL)
-    {
-        /* Turn on LED to signal failure */
-        P1OUT ^= BIT0;
-    }
-    else
-    {
-        /* Turn off LED to signal success */
-        P1OUT &= ~BIT0;
-    }
-}
-
-/****************************************************************************************
- * Func name: setMessageInBuffer
- * Descr: Set a dynamic message template.
- * @param message: The message string to be set as template.
- */
-void setMessageInBuffer(const char* message)
-{
-    /* No memory allocated -> alloc memory for the message */
-    if(messageBuffer.data == NULL)
-    {
-        allocateMessageBuffer(strlen(message) + 1);
-    }
-
-    /* Copy message to buffer and mark last character as NULL ending */
-    if(messageBuffer.data != NULL)
-    {
-        strncpy(messageBuffer.data, message, messageBuffer.size - 1);
-        messageBuffer.data[messageBuffer.size - 1] = '\0';
-        /* Mark message as ready to be sent trough UART TX Buffer */
-        messageBuffer.ready = true;
-    }
-}
-
-/****************************************************************************************
- * Func name: freeMessageBuffer
- * Descr: Free the memory allocated for the message template.
- * @param: none
- */
-void freeMessageBuffer()
-{
-    if (messageBuffer.data != NULL)
-    {
-        free(messageBuffer.data);
-        messageBuffer.data = NULL;
-        messageBuffer.size = 0;
-        messageBuffer.ready = false;
-        /* Signal end of message sending */
-        P6OUT &= ~BIT6;
-    }
-}
-
 /****************************************************************************************
  * Func name: SG90_Calibration
- * Descr: Initial calibration for SG90_Servo.
- * @param: unsigned int calib_time
+ * Descr: Initial calibration for SG90_Servo. Pulses come from the CH0 model table (SERVO_LutCh0, SG90 encoding:
+ *        0..90 -> 0°..+90°, 91..180 -> -1°..-90°), so every model stays inside its MIN / MAX.
+ * @param: unsigned int calib_time, unsigned int sg90_firstAngle, unsigned int sg90_secondAngle (degrees, 0..90)
  */
 void SG90_Calibration(unsigned int calib_time, unsigned int sg90_firstAngle, unsigned int sg90_secondAngle)
 {
+    if (sg90_firstAngle > 90u) sg90_firstAngle = 90u;
+    if (sg90_secondAngle > 90u) sg90_secondAngle = 90u;
+
+    /* Calibration pulses on CH0; the control loop takes over again at 0°, seeded from the feedback */
+    SG90_CalibActive = true;
+    SG90_PidSeeded = false;
 #if SG90_LONG_CALIB == 1 && SG90_SHRT_CALIB == 0
     int setup_cycle = 3;
     while(setup_cycle--)
@@ -739,29 +1803,30 @@ void SG90_Calibration(unsigned int calib_time, unsigned int sg90_firstAngle, uns
         if(setup_cycle == 2)
         {
             /* +90°, -90° și 0° at x second pace */
-            TB1CCR1 = SG90_P90DEG; delay_ms(calib_time);
-            TB1CCR1 = SG90_N90DEG;  delay_ms(calib_time);
-            TB1CCR1 = SG90_0DEG; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[90]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[180]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[0]; delay_ms(calib_time);
         }
         else if(setup_cycle == 1)
         {
             /* +45°, -45° și 0° at x second pace */
-            TB1CCR1 = SG90_P90DEG - sg90_firstAngle ; delay_ms(calib_time);
-            TB1CCR1 = SG90_N90DEG + sg90_firstAngle; delay_ms(calib_time);
-            TB1CCR1 = SG90_0DEG; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[sg90_firstAngle]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[90u + sg90_firstAngle]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[0]; delay_ms(calib_time);
         }
         else
         {
             /* +30°, -30° și 0° at x second pace */
-            TB1CCR1 = SG90_P90DEG - sg90_secondAngle; delay_ms(calib_time);
-            TB1CCR1 = SG90_N90DEG + sg90_secondAngle; delay_ms(calib_time);
-            TB1CCR1 = SG90_0DEG; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[sg90_secondAngle]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[90u + sg90_secondAngle]; delay_ms(calib_time);
+            TB1CCR1 = SERVO_LutCh0[0]; delay_ms(calib_time);
         }
     }
 #elif SG90_SHRT_CALIB == 1 && SG90_LONG_CALIB == 0
     /* 0° at x second pace */
-    TB1CCR1 = SG90_0DEG; delay_ms(calib_time);
+    TB1CCR1 = SERVO_LutCh0[0]; delay_ms(calib_time);
 #endif
+    SG90_CalibActive = false;
 }
 
 /****************************************************************************************
@@ -785,14 +1850,21 @@ void delay_ms(unsigned int ms)
 void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t digit)
 {
 #if UART_HDL_KEYBOARD == 1 && UART_HDL_LABVIEWSERIAL == 0
-    /* Input data from UART TX Buffer */
-    received_char = UCA1RXBUF;
+    /* Input data from UART RX queue (passed in as received_char) */
 
     /* Check for termination character (e.g., '\n' or '\0' or '\r') */
     if (received_char == '\n' || received_char == '\0' || received_char == '\r')
     {
-        /* Store permanent value */
-        memcpy((void *)&setNrOfDegrees, (const void *)&nrOfDegrees, sizeof(nrOfDegrees));
+        /* Command or rejected frame -> validate and apply; plain angle -> store permanent value for CH0 */
+        if (UART_CmdId != UART_CMD_NONE)
+        {
+            UART_COM_commitCmd();
+        }
+        else
+        {
+            memcpy((void *)&setNrOfDegrees[SERVO_CH0], (const void *)&nrOfDegrees, sizeof(nrOfDegrees));
+            UART_SetpointCmdCnt++;
+        }
         /* Reset the buffer index */
         buff_idx = 0;
         /* Reset the number of degrees value */
@@ -801,8 +1873,13 @@ void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t di
         memset((void *)&UART_RX_Buff, 0, sizeof(UART_RX_Buff));
     }
 
+    /* Command id, separator or digit of a command frame */
+    else if (UART_CMD_IS_ID(received_char) || UART_CmdId != UART_CMD_NONE)
+    {
+        UART_COM_handle_CmdChar(received_char);
+    }
     /* If the character is a digit (0-9), process it */
-    if (received_char >= '0' && received_char <= '9')
+    else if (received_char >= '0' && received_char <= '9')
     {
         /* Convert ASCII '0'-'9' to integer 0-9 */
         digit = received_char - '0';
@@ -827,18 +1904,27 @@ void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t di
     }
     else
     {
-        /* Handle invalid character (non-numeric) */
+        /* Handle invalid character (non-numeric): drop the rest of the frame */
+        UART_CmdId = UART_CMD_DISCARD;
+        UART_Stats.parseRejects++;
     }
 
 #elif UART_HDL_KEYBOARD == 0 && UART_HDL_LABVIEWSERIAL == 1
-    /* Input data from UART TX Buffer */
-    received_char = UCA1RXBUF;
+    /* Input data from UART RX queue (passed in as received_char) */
 
     /* Check for termination character (e.g., '\n' or '\0' or '\r') */
     if (received_char == '\n' || received_char == '\0' || received_char == '\r')
     {
-        /* Store permanent value */
-        memcpy((void *)&setNrOfDegrees, (const void *)&nrOfDegrees, sizeof(nrOfDegrees));
+        /* Command or rejected frame -> validate and apply; plain angle -> store permanent value for CH0 */
+        if (UART_CmdId != UART_CMD_NONE)
+        {
+            UART_COM_commitCmd();
+        }
+        else
+        {
+            memcpy((void *)&setNrOfDegrees[SERVO_CH0], (const void *)&nrOfDegrees, sizeof(nrOfDegrees));
+            UART_SetpointCmdCnt++;
+        }
         /* Reset the buffer index */
         buff_idx = 0;
         /* Reset the number of degrees value */
@@ -847,8 +1933,13 @@ void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t di
         memset((void *)&UART_RX_Buff, 0, sizeof(UART_RX_Buff));
     }
 
+    /* Command id, separator or digit of a command frame */
+    else if (UART_CMD_IS_ID(received_char) || UART_CmdId != UART_CMD_NONE)
+    {
+        UART_COM_handle_CmdChar(received_char);
+    }
     /* If the character is a digit (0-9), process it */
-    if (received_char >= '0' && received_char <= '9')
+    else if (received_char >= '0' && received_char <= '9')
     {
         /* Convert ASCII '0'-'9' to integer 0-9 */
         digit = received_char - '0';
@@ -873,7 +1964,9 @@ void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t di
     }
     else
     {
-        /* Handle invalid character (non-numeric) */
+        /* Handle invalid character (non-numeric): drop the rest of the frame */
+        UART_CmdId = UART_CMD_DISCARD;
+        UART_Stats.parseRejects++;
     }
 
 #endif
@@ -882,25 +1975,1180 @@ void UART_COM_handle_UartRxBuff(uint8_t buff_idx, char received_char, uint8_t di
 
 
 /****************************************************************************************
- * Func name: SG90_setAngle
- * Descr: Definition for SG90_setAngle function. Sets the angle of the servo motor
- * @param: nrOfDegrees
+ * Func name: UART_COM_handle_CmdChar
+ * Descr: Definition for UART_COM_handle_CmdChar. Handles command id, separator and digits of a command frame
+ * @param: char received_char
+ */
+void UART_COM_handle_CmdChar(char received_char)
+{
+    /* Rejected frame -> ignore everything up to the terminator */
+    if (UART_CmdId == UART_CMD_DISCARD)
+    {
+        return;
+    }
+    /* Command id -> start a new frame */
+    if (UART_CMD_IS_ID(received_char))
+    {
+        UART_CmdId = (uint8_t)received_char;
+        UART_CmdFieldIdx = 0;
+        memset((void *)&UART_CmdFields, 0, sizeof(UART_CmdFields));
+    }
+    /* Separator -> next field; extra fields are caught on commit */
+    else if (received_char == UART_CMD_FIELD_SEP)
+    {
+        if (UART_CmdFieldIdx < UART_GROUP_NR_OF_FIELDS)
+        {
+            UART_CmdFieldIdx++;
+        }
+    }
+    /* Digit -> accumulate the current field */
+    else if (received_char >= '0' && received_char <= '9')
+    {
+        if (UART_CmdFieldIdx < UART_GROUP_NR_OF_FIELDS)
+        {
+            uint16_t field = UART_CmdFields[UART_CmdFieldIdx] * 10u + (uint16_t)(received_char - '0');
+            /* Trim the max field value */
+            if (field > UART_CMD_FIELD_MAX) field = UART_CMD_FIELD_MAX;
+            UART_CmdFields[UART_CmdFieldIdx] = field;
+        }
+    }
+    else
+    {
+        /* Handle invalid character inside a command frame: drop the rest of the frame */
+        UART_CmdId = UART_CMD_DISCARD;
+        UART_Stats.parseRejects++;
+    }
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_commitCmd
+ * Descr: Definition for UART_COM_commitCmd. Validates and applies the command frame on terminator
+ * @param: none
+ */
+void UART_COM_commitCmd(void)
+{
+    uint8_t ch;
+
+    if (UART_CmdId == UART_CMD_DISCARD)
+    {
+        /* Rejected frame, already counted */
+    }
+    else if (UART_CmdId == UART_CMD_GROUP && UART_CmdFieldIdx == UART_GROUP_NR_OF_FIELDS - 1u &&
+        UART_CmdFields[0] <= UART_GROUP_SEQ_MAX)
+    {
+        /* Update all channels in one go; the main loop stages them as a single group */
+        for (ch = 0; ch < SERVO_NR_OF_CHANNELS; ch++)
+        {
+            uint16_t deg = UART_CmdFields[1u + ch];
+            /* Trim the max nr. of degrees */
+            setNrOfDegrees[ch] = (uint8_t)((deg > 180u) ? 180u : deg);
+        }
+        UART_GroupSeqId = (uint8_t)UART_CmdFields[0];
+        UART_SetpointCmdCnt++;
+    }
+    else if (UART_CmdId == UART_CMD_DUMP && UART_CmdFieldIdx == 0)
+    {
+        /* Dump runs from the main loop; "D" / "D0" telemetry log, "D1" serial capture.
+         * Not during a replay: the baud switch would cut the replay short */
+        if (!SCAP_Replaying)
+        {
+            TLOG_DumpRegion = (UART_CmdFields[0] != 0u) ? TLOG_REGION_CAPTURE : TLOG_REGION_SAMPLES;
+            TLOG_DumpRequest = true;
+        }
+    }
+    else if (UART_CmdId == UART_CMD_CAPTURE && UART_CmdFieldIdx == 0)
+    {
+        /* Replayed traffic must not reconfigure capture */
+        if (!SCAP_Replaying)
+        {
+            /* New capture starts with the state a replay has to start from */
+            if (UART_CmdFields[0] != 0u && SCAP_Mask == 0u)
+            {
+                SCAP_SaveState();
+            }
+            SCAP_Mask = (uint8_t)(UART_CmdFields[0] & (SCAP_RX | SCAP_TX));
+        }
+    }
+    else if (UART_CmdId == UART_CMD_REPLAY && UART_CmdFieldIdx == 0)
+    {
+        /* The capture usually ends with the "P" that started the replay: it must not restart it */
+        if (!SCAP_Replaying)
+        {
+            SCAP_StartReplay((uint8_t)((UART_CmdFields[0] > SCAP_REPLAY_MAX_SPEED) ? SCAP_REPLAY_MAX_SPEED : UART_CmdFields[0]));
+        }
+    }
+    else if (UART_CmdId == UART_CMD_RATE && UART_CmdFieldIdx == 0)
+    {
+        TB_SetTelemetryRate((uint8_t)((UART_CmdFields[0] > TLM_RATE_MAX_HZ) ? TLM_RATE_MAX_HZ : UART_CmdFields[0]));
+    }
+    else if (UART_CmdId == UART_CMD_WDT)
+    {
+        WDT_ReportRequest = true;
+    }
+    else if (UART_CmdId == UART_CMD_MODE && UART_CmdFieldIdx == 0)
+    {
+        TLM_Mode = (UART_CmdFields[0] != 0u) ? TLM_MODE_DELTA : TLM_MODE_FULL;
+        TLM_KeyframeRequest = true;
+    }
+    else if (UART_CmdId == UART_CMD_STATS)
+    {
+        UART_StatsRequest = true;
+    }
+    else if (UART_CmdId == UART_CMD_BENCH)
+    {
+        BENCH_ReportLine = 0;
+    }
+    else if (UART_CmdId == UART_CMD_TIMEOUT && UART_CmdFieldIdx == 0)
+    {
+        UART_RxTimeoutTicks = (uint8_t)((UART_CmdFields[0] > UART_RX_TIMEOUT_MAX) ? UART_RX_TIMEOUT_MAX : UART_CmdFields[0]);
+    }
+    else
+    {
+        /* Wrong nr. of fields */
+        UART_Stats.parseRejects++;
+    }
+    /* Reset command parser */
+    UART_CmdId = UART_CMD_NONE;
+    UART_CmdFieldIdx = 0;
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_enqueueTx
+ * Descr: Definition for UART_COM_enqueueTx. Queues a string for the TX interrupt; drops it if it does not fit
+ * @params: const char *data
+ * @return: true if queued
+ *
+ */
+bool UART_COM_enqueueTx(const char *data)
+{
+    size_t len = strlen(data);
+    /* Free space; one slot stays empty to tell full from empty */
+    uint8_t used = (uint8_t)(UART_TxHead - UART_TxTail);
+    size_t space = (UART_TX_QUEUE_SIZE - 1u) - used;
+    size_t i;
+
+    /* Whole frames only: a partial line is worse than a missing one */
+    if (len > space)
+    {
+        UART_Stats.txDrops++;
+        return false;
+    }
+    for (i = 0; i < len; i++)
+    {
+        UART_TxQueue[(uint8_t)(UART_TxHead + i)] = data[i];
+    }
+    /* Publish, then (re)start the TX interrupt */
+    UART_TxHead = (uint8_t)(UART_TxHead + len);
+    UCA1IE |= UCTXIE;
+    return true;
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_pushRx
+ * Descr: Definition for UART_COM_pushRx. Puts one byte in the RX queue and tracks the high-water mark (ISR context)
+ * @params: char data
+ * @return: false if the queue is full
+ *
+ */
+bool UART_COM_pushRx(char data)
+{
+    uint8_t used = (uint8_t)((UART_RxHead - UART_RxTail) & UART_RX_QUEUE_MASK);
+
+    if (used >= UART_RX_QUEUE_SIZE - 1u)
+    {
+        UART_Stats.rxQueueDrops++;
+        return false;
+    }
+    /* Stamp before publishing the byte: the main loop never sees a new byte with an old stamp */
+    UART_RxLastTick = tb1_cnt;
+    UART_RxQueue[UART_RxHead] = data;
+    UART_RxHead = (uint8_t)((UART_RxHead + 1u) & UART_RX_QUEUE_MASK);
+    if (used + 1u > UART_Stats.rxQueueHwm) UART_Stats.rxQueueHwm = used + 1u;
+    return true;
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_processRx
+ * Descr: Definition for UART_COM_processRx. Parses the bytes waiting in the RX queue (main loop context)
+ * @params: none
+ *
+ *
  */
-void SG90_setAngle(uint8_t nrOfDegrees)
+void UART_COM_processRx(void)
 {
-    int deg = nrOfDegrees;
+    /* UART RX Buffer index */
+    static uint8_t buff_idx = 0;
+    /* Bytes received since the last terminator */
+    static bool frameOpen = false;
+#if BENCH_ENABLE == 1
+    /* Parse cycles of the open command */
+    static uint32_t cmdCycles = 0;
+#endif
+    /* Received char */
+    char received_char;
+    bool terminator;
 
-    /* Change deg in interval 90-180 to interval to 0 -90 */
-    if(deg >= 0 && deg <= 90)
+    while (UART_RxTail != UART_RxHead)
+    {
+        received_char = UART_RxQueue[UART_RxTail];
+        UART_RxTail = (uint8_t)((UART_RxTail + 1u) & UART_RX_QUEUE_MASK);
+        terminator = (received_char == '\n' || received_char == '\0' || received_char == '\r');
+        /* Terminator without a frame ("\r\n" pair, late terminator after a timeout): nothing to commit */
+        if (terminator && !frameOpen) continue;
+        frameOpen = !terminator;
+#if BENCH_ENABLE == 1
+        {
+            BENCH_START(BENCH_PARSE);
+            UART_COM_handle_UartRxBuff(buff_idx, received_char, 0);
+            /* Whole command: its bytes summed up to the terminator, one sample per command */
+            cmdCycles += BENCH_STOP(BENCH_PARSE);
+            if (terminator)
+            {
+                BENCH_AddSample(BENCH_COMMAND, (uint16_t)((cmdCycles > 0xFFFFu) ? 0xFFFFu : cmdCycles));
+                cmdCycles = 0;
+            }
+        }
+#else
+        UART_COM_handle_UartRxBuff(buff_idx, received_char, 0);
+#endif
+    }
+
+    /* Replay is over once the ISR pushed the last record and the parser consumed it */
+    if (SCAP_Replaying && !SCAP_ReplayActive && UART_RxTail == UART_RxHead)
+    {
+        SCAP_Replaying = false;
+    }
+
+    /* Line idle with a partial frame: close it so the next command starts clean */
+    if (frameOpen && UART_RxTimeoutTicks != 0u &&
+        (uint16_t)(tb1_cnt - UART_RxLastTick) >= UART_RxTimeoutTicks)
+    {
+        UART_Stats.rxTimeouts++;
+#if UART_RX_TIMEOUT_COMMIT == 1
+        UART_COM_handle_UartRxBuff(buff_idx, '\r', 0);
+#else
+        UART_COM_flushFrame();
+#endif
+#if BENCH_ENABLE == 1
+        cmdCycles = 0;
+#endif
+        frameOpen = false;
+    }
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_flushFrame
+ * Descr: Definition for UART_COM_flushFrame. Drops a partial frame and resets the parser (main loop context)
+ * @params: none
+ *
+ *
+ */
+void UART_COM_flushFrame(void)
+{
+    /* Reset the number of degrees value */
+    nrOfDegrees = 0;
+    /* Reset command parser */
+    UART_CmdId = UART_CMD_NONE;
+    UART_CmdFieldIdx = 0;
+    /* Clear the buffer */
+    memset((void *)&UART_RX_Buff, 0, sizeof(UART_RX_Buff));
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_FormatStats
+ * Descr: Definition for UART_COM_FormatStats. Formats the link health counters
+ * @params: char *msg, size_t size
+ *
+ *
+ */
+void UART_COM_FormatStats(char *msg, size_t size)
+{
+    snprintf(msg, size,
+             "UART [oe: %d fe: %d] [rxq drop: %d hwm: %d] [rej: %d] [tmo: %d] [txq drop: %d] \n\r",
+             (int)UART_Stats.rxOverrun,
+             (int)UART_Stats.rxFraming,
+             (int)UART_Stats.rxQueueDrops,
+             (int)UART_Stats.rxQueueHwm,
+             (int)UART_Stats.parseRejects,
+             (int)UART_Stats.rxTimeouts,
+             (int)UART_Stats.txDrops);
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_SetBaud
+ * Descr: Definition for UART_COM_SetBaud. Switches eUSCI A1 between the default and the dump baud rate
+ * @param: bool dumpBaud
+ */
+void UART_COM_SetBaud(bool dumpBaud)
+{
+    /* Let the last byte leave the shift register */
+    while (UCA1STATW & UCBUSY);
+    /* eUSCI_Ax Control Word Register 0 -> SET TO -> Software reset enable */
+    UCA1CTLW0 |= UCSWRST;
+    if (dumpBaud)
+    {
+        /* SMClk (1 MHz) -> 115200bps */
+        UCA1CTLW0 = (UCA1CTLW0 & ~UCSSEL_3) | UCSSEL__SMCLK;
+        UCA1BR0 = COM_UART_BRDumpOption[0];
+        UCA1BR1 = COM_UART_BRDumpOption[1];
+        UCA1MCTLW = BR_DUMP_MSET;
+    }
+    else
+    {
+        /* AClk (32768 Hz) -> 9600bps */
+        UCA1CTLW0 = (UCA1CTLW0 & ~UCSSEL_3) | UCSSEL_1;
+        UCA1BR0 = COM_UART_BROption[0];
+        UCA1BR1 = COM_UART_BROption[1];
+        UCA1MCTLW = BR_MSET;
+    }
+    /* Initialize eUSCI; reset clears UCRXIE, restore it */
+    UCA1CTLW0 &= ~UCSWRST;
+    UCA1IE |= UCRXIE;
+}
+
+/****************************************************************************************
+ * Func name: UART_COM_putChar
+ * Descr: Definition for UART_COM_putChar. Blocking send of one byte trough UART TX Buffer
+ * @param: uint8_t data
+ */
+void UART_COM_putChar(uint8_t data)
+{
+    /* Wait for no interrupts from eUSCI A1 UART  */
+    while (!(UCA1IFG & UCTXIFG));
+    UCA1TXBUF = data;
+}
+
+/****************************************************************************************
+ * Func name: TLOG_Record
+ * Descr: Definition for TLOG_Record. Records one sample in the FRAM circular log (TB1 ISR context)
+ * @param: none
+ */
+void TLOG_Record(void)
+{
+    TLOG_Sample *sample = &TLOG_Buff[TLOG_Head];
+
+    sample->tick = tb1_cnt;
+    sample->ccr[SERVO_CH0] = TB1CCR1;
+    sample->ccr[SERVO_CH1] = TB1CCR2;
+    sample->deg[SERVO_CH0] = setNrOfDegrees[SERVO_CH0];
+    sample->deg[SERVO_CH1] = setNrOfDegrees[SERVO_CH1];
+    sample->seq = SERVO_CommittedSeqId;
+    sample->flags = ((SCAP_Mask != 0u) ? TLOG_FLAG_CAPTURE : 0u) | (SCAP_Replaying ? TLOG_FLAG_REPLAY : 0u);
+    sample->fb = ADC_PosRaw;
+
+    /* Advance head; count saturates at log size */
+    TLOG_Head = (TLOG_Head + 1u < TLOG_NR_OF_SAMPLES) ? (TLOG_Head + 1u) : 0u;
+    if (TLOG_Count < TLOG_NR_OF_SAMPLES)
+    {
+        TLOG_Count++;
+    }
+}
+
+/****************************************************************************************
+ * Func name: TLOG_Dump
+ * Descr: Definition for TLOG_Dump. Announces the dump at the current baud ("DUMP <magic> n: <count> baud: 115200",
+ *        the capture adds "lost: <bytes>" before the baud),
+ *        waits TLOG_DUMP_GUARD_MS at the new baud, then streams an FRAM log region, oldest record first.
+ *        Frame: "TLOG"/"SCAP" | record size | count (LE16) | blocks of ['B' | n | n records | XOR checksum] | "TEND"
+ * @param: uint8_t region
+ */
+void TLOG_Dump(uint8_t region)
+{
+    const uint8_t *base;
+    uint8_t recSize;
+    uint16_t capacity;
+    const char *magic;
+    uint16_t idx;
+    uint16_t left;
+    uint8_t n;
+    uint8_t checksum;
+    const uint8_t *data;
+    uint8_t i;
+    /* Announce line (static: keeps it off the 160 byte stack) */
+    static char announce[48];
+
+    if (region == TLOG_REGION_CAPTURE)
+    {
+        base = (const uint8_t *)SCAP_Buff;
+        recSize = (uint8_t)sizeof(SCAP_Record);
+        capacity = SCAP_NR_OF_RECORDS;
+        magic = "SCAP";
+    }
+    else
+    {
+        base = (const uint8_t *)TLOG_Buff;
+        recSize = (uint8_t)sizeof(TLOG_Sample);
+        capacity = TLOG_NR_OF_SAMPLES;
+        magic = "TLOG";
+    }
+
+    /* Freeze logging and periodic messages */
+    TLOG_DumpActive = true;
+    /* Capture is paused with the log, the ring cannot move under the dump */
+    if (region == TLOG_REGION_CAPTURE)
+    {
+        idx = (SCAP_Head + SCAP_NR_OF_RECORDS - SCAP_Count) % SCAP_NR_OF_RECORDS;
+        left = SCAP_Count;
+    }
+    else
+    {
+        idx = (TLOG_Head + TLOG_NR_OF_SAMPLES - TLOG_Count) % TLOG_NR_OF_SAMPLES;
+        left = TLOG_Count;
+    }
+
+    /* Announce the switch at the current baud; queued messages go out first, so the announce always fits */
+    if (region == TLOG_REGION_CAPTURE)
+    {
+        snprintf(announce, sizeof(announce), "DUMP %s n: %d lost: %d baud: 115200\n\r", magic, (int)left,
+                 (int)((SCAP_Lost > 0x7FFFu) ? 0x7FFFu : SCAP_Lost));
+    }
+    else
+    {
+        snprintf(announce, sizeof(announce), "DUMP %s n: %d baud: 115200\n\r", magic, (int)left);
+    }
+    while (UART_TxHead != UART_TxTail)
+    {
+        WDT_CheckIn(WDT_TASK_MAIN);
+    }
+    if (!UART_COM_enqueueTx(announce))
+    {
+        /* Not announced: the host would not follow the baud switch */
+        TLOG_DumpActive = false;
+        return;
+    }
+    while (UART_TxHead != UART_TxTail)
+    {
+        WDT_CheckIn(WDT_TASK_MAIN);
+    }
+
+    /* Dump runs inside the main loop task */
+    WDT_CheckIn(WDT_TASK_MAIN);
+    /* Switch link to the highest configured baud, then give the host time to follow */
+    UART_COM_SetBaud(true);
+    delay_ms(TLOG_DUMP_GUARD_MS);
+
+    /* Header */
+    for (i = 0; i < 4u; i++)
+    {
+        UART_COM_putChar((uint8_t)magic[i]);
+    }
+    UART_COM_putChar(recSize);
+    UART_COM_putChar((uint8_t)(left & 0xFFu));
+    UART_COM_putChar((uint8_t)(left >> 8));
+
+    /* Blocks */
+    while (left > 0)
+    {
+        n = (left > TLOG_DUMP_BLOCK) ? TLOG_DUMP_BLOCK : (uint8_t)left;
+        checksum = 0;
+        UART_COM_putChar(TLOG_DUMP_BLOCK_ID);
+        UART_COM_putChar(n);
+        left -= n;
+        while (n--)
+        {
+            data = base + (uint16_t)idx * recSize;
+            for (i = 0; i < recSize; i++)
+            {
+                checksum ^= data[i];
+                UART_COM_putChar(data[i]);
+            }
+            idx = (idx + 1u < capacity) ? (idx + 1u) : 0u;
+        }
+        UART_COM_putChar(checksum);
+        WDT_CheckIn(WDT_TASK_MAIN);
+    }
+
+    /* Trailer */
+    UART_COM_putChar('T'); UART_COM_putChar('E'); UART_COM_putChar('N'); UART_COM_putChar('D');
+
+    /* Back to the default baud and resume logging */
+    UART_COM_SetBaud(false);
+    TLOG_DumpActive = false;
+}
+
+/****************************************************************************************
+ * Func name: WDT_InitSupervisor
+ * Descr: Definition for WDT_InitSupervisor. Snapshots the previous run, latches the reset cause in FRAM and
+ *        arms the task deadlines.
+ * @param: none
+ */
+void WDT_InitSupervisor(void)
+{
+    uint16_t cause = SYSRSTIV;
+    uint8_t task;
+
+    /* First read returns the highest priority cause; drain the rest */
+    while (SYSRSTIV != SYSRSTIV_NONE);
+
+    /* Last tick / late mask / missed counters still describe the previous run: keep them for the report */
+    memcpy(&WDT_PrevRun, &WDT_ResetInfo, sizeof(WDT_PrevRun));
+
+    WDT_ResetInfo.resetCount++;
+    WDT_ResetInfo.lastCause = cause;
+    if (cause == SYSRSTIV_WDTTO)
+    {
+        WDT_ResetInfo.wdtResetCount++;
+    }
+
+    for (task = 0; task < WDT_NR_OF_TASKS; task++)
+    {
+        WDT_TaskLastTick[task] = 0;
+        WDT_Missed[task] = 0;
+    }
+    WDT_TaskDeadline[WDT_TASK_MAIN] = WDT_DEADLINE_MAIN;
+    WDT_TaskDeadline[WDT_TASK_TLM] = (uint16_t)(TLM_RATE_MAX_HZ / TB0_DELAY_SECONDS) + WDT_DEADLINE_MARGIN;
+    WDT_TaskDeadline[WDT_TASK_CTRL] = WDT_SUPERVISE_TICKS;
+    WDT_LateMask = 0;
+    WDT_ArmedMask = (1u << WDT_TASK_TLM) | (1u << WDT_TASK_CTRL);
+    WDT_ReportRequest = false;
+}
+
+/****************************************************************************************
+ * Func name: WDT_CheckIn
+ * Descr: Definition for WDT_CheckIn. Marks a periodic task as alive
+ * @param: uint8_t task
+ */
+void WDT_CheckIn(uint8_t task)
+{
+    WDT_TaskLastTick[task] = tb1_cnt;
+}
+
+/****************************************************************************************
+ * Func name: WDT_Supervise
+ * Descr: Definition for WDT_Supervise. Checks every armed task against its deadline, services the WDT only if none
+ *        was late, and saves the state in FRAM. A stall of TB1 itself stops the servicing -> reset after 1 s.
+ * @param: none
+ */
+void WDT_Supervise(void)
+{
+    uint8_t task;
+
+    for (task = 0; task < WDT_NR_OF_TASKS; task++)
+    {
+        if ((WDT_ArmedMask & (1u << task)) &&
+            (uint16_t)(tb1_cnt - WDT_TaskLastTick[task]) > WDT_TaskDeadline[task])
+        {
+            WDT_Missed[task]++;
+            WDT_LateMask |= (1u << task);
+        }
+    }
+
+    /* Save the state for post-mortem */
+    WDT_ResetInfo.lastTick = tb1_cnt;
+    WDT_ResetInfo.lateMask = WDT_LateMask;
+    for (task = 0; task < WDT_NR_OF_TASKS; task++)
+    {
+        WDT_ResetInfo.missed[task] = WDT_Missed[task];
+    }
+
+    if (WDT_LateMask == 0u)
+    {
+        WDTCTL = WDT_KICK;
+    }
+    WDT_LateMask = 0;
+}
+
+/****************************************************************************************
+ * Func name: WDT_FormatReport
+ * Descr: Definition for WDT_FormatReport. Formats reset cause, the state saved before the last reset and the
+ *        missed deadlines of the current run (main / tlm / ctrl)
+ * @param: char *msg, size_t size
+ */
+void WDT_FormatReport(char *msg, size_t size)
+{
+    snprintf(msg, size,
+             "WDT [rst: %d cause: %d wdt: %d] [prev tick: %d late: %d miss: %d/%d/%d] [now tick: %d miss: %d/%d/%d] \n\r",
+             (int)WDT_ResetInfo.resetCount,
+             (int)WDT_ResetInfo.lastCause,
+             (int)WDT_ResetInfo.wdtResetCount,
+             (int)WDT_PrevRun.lastTick,
+             (int)WDT_PrevRun.lateMask,
+             (int)WDT_PrevRun.missed[WDT_TASK_MAIN],
+             (int)WDT_PrevRun.missed[WDT_TASK_TLM],
+             (int)WDT_PrevRun.missed[WDT_TASK_CTRL],
+             (int)tb1_cnt,
+             (int)WDT_Missed[WDT_TASK_MAIN],
+             (int)WDT_Missed[WDT_TASK_TLM],
+             (int)WDT_Missed[WDT_TASK_CTRL]);
+}
+
+/****************************************************************************************
+ * Func name: SCAP_Capture
+ * Descr: Definition for SCAP_Capture. Appends one byte to the FRAM serial capture (ISR context).
+ *        Paused while a dump streams the capture. A full capture keeps its start and counts the lost bytes.
+ * @param: uint8_t dir, uint8_t data
+ */
+void SCAP_Capture(uint8_t dir, uint8_t data)
+{
+    SCAP_Record *rec;
+
+    if (TLOG_DumpActive)
+    {
+        return;
+    }
+    if (SCAP_Count >= SCAP_NR_OF_RECORDS)
+    {
+        if (SCAP_Lost < 0xFFFFu)
+        {
+            SCAP_Lost++;
+        }
+        return;
+    }
+    rec = &SCAP_Buff[SCAP_Count];
+    rec->tick = tb1_cnt;
+    rec->dir = dir;
+    rec->data = data;
+    SCAP_Count++;
+    SCAP_Head = (SCAP_Count < SCAP_NR_OF_RECORDS) ? SCAP_Count : 0u;
+}
+
+/****************************************************************************************
+ * Func name: SCAP_SaveState
+ * Descr: Definition for SCAP_SaveState. Starts an empty capture with the start state records: setpoints,
+ *        group sequence ID, telemetry mode and rate, all stamped with the capture start tick (main loop,
+ *        capture still off)
+ * @param: none
+ */
+void SCAP_SaveState(void)
+{
+    uint8_t state[SCAP_NR_OF_STATE_FIELDS];
+    uint16_t tick = tb1_cnt;
+    uint8_t i;
+
+    state[SCAP_STATE_DEG0] = setNrOfDegrees[SERVO_CH0];
+    state[SCAP_STATE_DEG1] = setNrOfDegrees[SERVO_CH1];
+    state[SCAP_STATE_SEQ] = UART_GroupSeqId;
+    state[SCAP_STATE_TLM_MODE] = TLM_Mode;
+    state[SCAP_STATE_TLM_RATE] = TLM_RateHz;
+    for (i = 0; i < SCAP_NR_OF_STATE_FIELDS; i++)
+    {
+        SCAP_Buff[i].tick = tick;
+        SCAP_Buff[i].dir = SCAP_STATE;
+        SCAP_Buff[i].data = state[i];
+    }
+    SCAP_Count = SCAP_NR_OF_STATE_FIELDS;
+    SCAP_Head = SCAP_NR_OF_STATE_FIELDS;
+    SCAP_Lost = 0;
+}
+
+/****************************************************************************************
+ * Func name: SCAP_RestoreState
+ * Descr: Definition for SCAP_RestoreState. Restores the start state recorded at the head of the capture.
+ *        The servos start at rest on the restored setpoints: capture is meant to start with the servos settled.
+ *        Interrupts disabled by the caller.
+ * @param: none
+ */
+void SCAP_RestoreState(void)
+{
+    uint8_t ch;
+
+    setNrOfDegrees[SERVO_CH0] = SCAP_Buff[SCAP_STATE_DEG0].data;
+    setNrOfDegrees[SERVO_CH1] = SCAP_Buff[SCAP_STATE_DEG1].data;
+    UART_GroupSeqId = SCAP_Buff[SCAP_STATE_SEQ].data;
+    TLM_Mode = (SCAP_Buff[SCAP_STATE_TLM_MODE].data != 0u) ? TLM_MODE_DELTA : TLM_MODE_FULL;
+    TLM_KeyframeRequest = true;
+    TB_SetTelemetryRate(SCAP_Buff[SCAP_STATE_TLM_RATE].data);
+
+    for (ch = 0; ch < SERVO_NR_OF_CHANNELS; ch++)
+    {
+        SG90_setAngle(ch, setNrOfDegrees[ch]);
+        SERVO_TargetCCR[ch] = SERVO_ShadowCCR[ch];
+        SERVO_OutCCR[ch] = SERVO_ShadowCCR[ch];
+        SMOOTH_init(ch, SERVO_ShadowCCR[ch]);
+    }
+    SMOOTH_HaveCmd = false;
+    SERVO_CommittedSeqId = UART_GroupSeqId;
+    SERVO_CommittedCmdCnt = UART_SetpointCmdCnt;
+    SERVO_ShadowPending = false;
+    SG90_PidSeeded = false;
+}
+
+/****************************************************************************************
+ * Func name: SCAP_StartReplay
+ * Descr: Definition for SCAP_StartReplay. Stops capture, restores the recorded start state and starts feeding
+ *        the captured RX bytes to the parser with their original offsets from the capture start. Resulting motion
+ *        lands in the telemetry log ("D0", flagged TLOG_FLAG_REPLAY) for comparison with the log recorded during
+ *        the original session (flagged TLOG_FLAG_CAPTURE), see tools/trace_diff.py.
+ * @param: uint8_t speed
+ */
+void SCAP_StartReplay(uint8_t speed)
+{
+    __disable_interrupt();
+    SCAP_Mask = 0;
+    SCAP_ReplayIdx = 0;
+    SCAP_ReplayLeft = SCAP_Count;
+    if (SCAP_Count >= SCAP_NR_OF_STATE_FIELDS && SCAP_Buff[0].dir == SCAP_STATE)
+    {
+        SCAP_RestoreState();
+        SCAP_ReplayIdx = SCAP_NR_OF_STATE_FIELDS;
+        SCAP_ReplayLeft = SCAP_Count - SCAP_NR_OF_STATE_FIELDS;
+    }
+    SCAP_ReplayBaseTick = SCAP_Buff[0].tick;
+    SCAP_ReplayClock = 0;
+    SCAP_ReplaySpeed = speed;
+    SCAP_ReplayActive = (SCAP_ReplayLeft > 0u);
+    SCAP_Replaying = SCAP_ReplayActive;
+    __enable_interrupt();
+}
+
+/****************************************************************************************
+ * Func name: SCAP_ReplayStep
+ * Descr: Definition for SCAP_ReplayStep. Advances the replay clock by one period x speed and pushes the RX
+ *        records due by then into the RX queue; TX records are skipped. Never overfills the RX queue.
+ * @param: none
+ */
+void SCAP_ReplayStep(void)
+{
+    const SCAP_Record *rec;
+
+    /* Replay clock in original ticks; speed 0 -> everything is due */
+    if (SCAP_ReplaySpeed == 0u || (uint16_t)(0xFFFFu - SCAP_ReplayClock) < SCAP_ReplaySpeed)
+    {
+        SCAP_ReplayClock = 0xFFFFu;
+    }
+    else
+    {
+        SCAP_ReplayClock += SCAP_ReplaySpeed;
+    }
+
+    while (SCAP_ReplayLeft > 0u)
+    {
+        rec = &SCAP_Buff[SCAP_ReplayIdx];
+        /* Not due yet */
+        if ((uint16_t)(rec->tick - SCAP_ReplayBaseTick) > SCAP_ReplayClock)
+        {
+            break;
+        }
+        if (rec->dir == SCAP_RX)
+        {
+            /* Queue full: retry on the next period */
+            if (((UART_RxHead - UART_RxTail) & UART_RX_QUEUE_MASK) >= UART_RX_QUEUE_SIZE - 1u)
+            {
+                break;
+            }
+            UART_COM_pushRx((char)rec->data);
+        }
+        SCAP_ReplayIdx = (SCAP_ReplayIdx + 1u < SCAP_NR_OF_RECORDS) ? (SCAP_ReplayIdx + 1u) : 0u;
+        SCAP_ReplayLeft--;
+    }
+    if (SCAP_ReplayLeft == 0u)
+    {
+        SCAP_ReplayActive = false;
+    }
+}
+
+/****************************************************************************************
+ * Func name: TLM_FormatMessage
+ * Descr: Definition for TLM_FormatMessage. Full mode: status line every tick. Delta mode: "D<tick>" plus the
+ *        changed fields only (a0/a1 setpoint, t temp val, p0/p1 PWM, s seq), nothing if unchanged,
+ *        and a full line every TLM_KEYFRAME_PERIOD ticks.
+ * @param: char *msg, size_t size
+ * @return: message length, 0 when there is nothing to send
+ */
+size_t TLM_FormatMessage(char *msg, size_t size)
+{
+    TLM_Fields now;
+    size_t len = 0;
+    uint8_t ch;
+
+    /* Sample the fields */
+    now.deg[SERVO_CH0] = setNrOfDegrees[SERVO_CH0];
+    now.deg[SERVO_CH1] = setNrOfDegrees[SERVO_CH1];
+    now.tmp = nrOfDegrees;
+    now.seq = SERVO_CommittedSeqId;
+    now.ccr[SERVO_CH0] = TB1CCR1;
+    now.ccr[SERVO_CH1] = TB1CCR2;
+    now.err = UART_Stats.rxOverrun + UART_Stats.rxFraming +
+              UART_Stats.rxQueueDrops + UART_Stats.parseRejects + UART_Stats.rxTimeouts + UART_Stats.txDrops;
+
+    if (TLM_Mode == TLM_MODE_FULL || TLM_KeyframeRequest || TLM_FramesSinceKey >= TLM_KEYFRAME_PERIOD - 1u)
+    {
+        /* Format the message string including the counter value */
+        snprintf(msg, size,
+                 "Program counter [TB0]: %d ticks txq: %d  [Servo rotation: %d deg. [temp val: %d]| PWM: %d ms] [CH1: %d deg.| PWM: %d] [seq: %d] [err: %d] \n\r\r",
+                 (int)tb0_cnt,
+                 (uint8_t)(UART_TxHead - UART_TxTail),
+                 (uint8_t)now.deg[SERVO_CH0],
+                 (uint8_t)now.tmp,
+                 (uint16_t)now.ccr[SERVO_CH0],
+                 (uint8_t)now.deg[SERVO_CH1],
+                 (uint16_t)now.ccr[SERVO_CH1],
+                 (uint8_t)now.seq,
+                 (int)now.err);
+        len = strlen(msg);
+        /* Truncated line: keep the terminator so the host still splits lines */
+        if (len >= size - 1u && size >= 3u)
+        {
+            msg[size - 3u] = '\n';
+            msg[size - 2u] = '\r';
+        }
+        TLM_KeyframeRequest = false;
+        TLM_FramesSinceKey = 0;
+    }
+    else
+    {
+        TLM_FramesSinceKey++;
+        /* Nothing changed -> nothing to send */
+        if (memcmp(&now, &TLM_LastSent, sizeof(now)) == 0)
+        {
+            return 0;
+        }
+        len = (size_t)snprintf(msg, size, "D%d", (int)tb0_cnt);
+        for (ch = 0; ch < SERVO_NR_OF_CHANNELS; ch++)
+        {
+            if (now.deg[ch] != TLM_LastSent.deg[ch] && len < size)
+            {
+                len += (size_t)snprintf(msg + len, size - len, " a%d=%d", (int)ch, (int)now.deg[ch]);
+            }
+            if (now.ccr[ch] != TLM_LastSent.ccr[ch] && len < size)
+            {
+                len += (size_t)snprintf(msg + len, size - len, " p%d=%d", (int)ch, (int)now.ccr[ch]);
+            }
+        }
+        if (now.tmp != TLM_LastSent.tmp && len < size)
+        {
+            len += (size_t)snprintf(msg + len, size - len, " t=%d", (int)now.tmp);
+        }
+        if (now.seq != TLM_LastSent.seq && len < size)
+        {
+            len += (size_t)snprintf(msg + len, size - len, " s=%d", (int)now.seq);
+        }
+        if (now.err != TLM_LastSent.err && len < size)
+        {
+            len += (size_t)snprintf(msg + len, size - len, " e=%d", (int)now.err);
+        }
+        if (len < size)
+        {
+            len += (size_t)snprintf(msg + len, size - len, "\n\r");
+        }
+        if (len >= size)
+        {
+            len = size - 1u;
+        }
+    }
+    TLM_LastSent = now;
+    return len;
+}
+
+/****************************************************************************************
+ * Func name: SG90_closedLoopCCR
+ * Descr: Definition for SG90_closedLoopCCR. Converts the feedback to compare counts and adds the PID correction
+ *        to the target; result is kept inside the CH0 model pulse range. The first step seeds the PID from the
+ *        sample, so taking over from calibration does not kick the output.
+ * @param: uint16_t targetCCR, uint16_t adcRaw
+ * @return: compare value to drive
+ */
+uint16_t SG90_closedLoopCCR(uint16_t targetCCR, uint16_t adcRaw)
+{
+    /* Measured position in compare counts */
+    int16_t measured = (int16_t)(SERVO_PARAM(SERVO_CH0_MODEL, MIN) + (((int32_t)adcRaw - FB_ADC_N90DEG) * FB_CCR_PER_ADC_Q12 >> 12));
+    int16_t out;
+
+    if (!SG90_PidSeeded)
+    {
+        PID_seed(&SG90_PosPid, (int16_t)targetCCR - measured, measured);
+        SG90_PidSeeded = true;
+    }
+    out = (int16_t)targetCCR + PID_step(&SG90_PosPid, (int16_t)targetCCR - measured, measured);
+
+    /* Trim to CH0 model pulse limits */
+    if (out < (int16_t)SERVO_PARAM(SERVO_CH0_MODEL, MIN)) out = SERVO_PARAM(SERVO_CH0_MODEL, MIN);
+    if (out > (int16_t)SERVO_PARAM(SERVO_CH0_MODEL, MAX)) out = SERVO_PARAM(SERVO_CH0_MODEL, MAX);
+    return (uint16_t)out;
+}
+
+/****************************************************************************************
+ * Func name: SG90_setAngle
+ * Descr: Definition for SG90_setAngle function. Stages the angle of a servo channel in the shadow table
+ * @param: uint8_t channel, uint8_t nrOfDegrees
+ */
+void SG90_setAngle(uint8_t channel, uint8_t nrOfDegrees)
+{
+    /* Set angle from the channel model table (0..90 -> 0°..+90°, 91..180 -> -1°..-90°, limits applied at build time) */
+    if(nrOfDegrees <= SERVO_CMD_MAX_DEG)
+    {
+        SERVO_ShadowCCR[channel] = SERVO_Lut[channel][nrOfDegrees];
+    }
+}
+
+/****************************************************************************************
+ * Func name: SERVO_StageGroup
+ * Descr: Definition for SERVO_StageGroup. Stages every channel under one lock so the period boundary never sees
+ *        a partial group (main loop)
+ * @param: none
+ */
+void SERVO_StageGroup(void)
+{
+    /* Channel index */
+    uint8_t ch;
+
+    __disable_interrupt();
+    for(ch = 0; ch < SERVO_NR_OF_CHANNELS; ch++)
+    {
+        BENCH_START(BENCH_SET_ANGLE);
+        SG90_setAngle(ch, setNrOfDegrees[ch]);
+        BENCH_STOP(BENCH_SET_ANGLE);
+    }
+    SERVO_ShadowSeqId = UART_GroupSeqId;
+    SERVO_ShadowCmdCnt = UART_SetpointCmdCnt;
+    SERVO_ShadowPending = true;
+    __enable_interrupt();
+}
+
+/****************************************************************************************
+ * Func name: BENCH_PaintStack
+ * Descr: Definition for BENCH_PaintStack. Fills the stack below the current frame with a pattern
+ * @params: none
+ *
+ *
+ */
+void BENCH_PaintStack(void)
+{
+    uint16_t *p = &_stack;
+    /* Stack grows down: everything below SP is free */
+    uint16_t *sp = (uint16_t *)__get_SP_register();
+
+    while (p < sp)
+    {
+        *p++ = BENCH_STACK_PAINT;
+    }
+}
+
+/****************************************************************************************
+ * Func name: BENCH_StackUsed
+ * Descr: Definition for BENCH_StackUsed. The first overwritten word from the bottom marks the deepest use.
+ *        ISRs do not nest here, so this is main + the deepest ISR seen so far
+ * @params: none
+ * @return: bytes
+ *
+ */
+uint16_t BENCH_StackUsed(void)
+{
+    const uint16_t *p = &_stack;
+
+    while (p < &__STACK_END && *p == BENCH_STACK_PAINT)
+    {
+        p++;
+    }
+    return (uint16_t)((&__STACK_END - p) * sizeof(uint16_t));
+}
+
+/****************************************************************************************
+ * Func name: BENCH_Record
+ * Descr: Definition for BENCH_Record. Adds one raw TB2 interval to a probe, less the probe overhead
+ * @params: uint8_t probe, uint16_t cycles
+ * @return: net cycles recorded
+ *
+ */
+uint16_t BENCH_Record(uint8_t probe, uint16_t cycles)
+{
+    cycles = (cycles > BENCH_Overhead) ? (uint16_t)(cycles - BENCH_Overhead) : 0u;
+    BENCH_AddSample(probe, cycles);
+    return cycles;
+}
+
+/****************************************************************************************
+ * Func name: BENCH_AddSample
+ * Descr: Definition for BENCH_AddSample. Adds one sample (net cycles) to a probe (probe owner context: main loop
+ *        or its ISR)
+ * @params: uint8_t probe, uint16_t cycles
+ *
+ *
+ */
+void BENCH_AddSample(uint8_t probe, uint16_t cycles)
+{
+    volatile BENCH_Probe *p = &BENCH_Probes[probe];
+
+    if (p->count < 0xFFFFu)
+    {
+        p->count++;
+        p->total += cycles;
+    }
+    if (cycles < p->min) p->min = cycles;
+    if (cycles > p->max) p->max = cycles;
+}
+
+/****************************************************************************************
+ * Func name: BENCH_ResetProbe
+ * Descr: Definition for BENCH_ResetProbe. Restarts the statistics of a probe
+ * @params: uint8_t probe
+ *
+ *
+ */
+void BENCH_ResetProbe(uint8_t probe)
+{
+    BENCH_Probes[probe].count = 0;
+    BENCH_Probes[probe].min = 0xFFFFu;
+    BENCH_Probes[probe].max = 0;
+    BENCH_Probes[probe].total = 0;
+    BENCH_Probes[probe].startTick = tb1_cnt;
+}
+
+/****************************************************************************************
+ * Func name: BENCH_FormatReport
+ * Descr: Definition for BENCH_FormatReport. Probe lines: samples, worst / average cycles, the rate one
+ *        core could sustain (cap/s: frames/s for fmt, commands/s for cmd) and the rate seen since the last
+ *        report (rate/s); last line: stack high-water mark and section sizes (bytes).
+ *        Values above budget are flagged with '!'
+ * @params: uint8_t line, char *msg, size_t size
+ * @return: message length, 0 if the line is not available
+ *
+ */
+size_t BENCH_FormatReport(uint8_t line, char *msg, size_t size)
+{
+    int len;
+
+    if (line < BENCH_NR_OF_PROBES)
+    {
+#if BENCH_ENABLE == 1
+        BENCH_Probe probe;
+        uint16_t avg;
+        uint32_t cap;
+        uint32_t rate;
+        uint16_t ticks;
+
+        /* Consistent copy: ISR probes are updated from interrupt context */
+        __disable_interrupt();
+        probe = BENCH_Probes[line];
+        BENCH_ResetProbe(line);
+        ticks = (uint16_t)(tb1_cnt - probe.startTick);
+        __enable_interrupt();
+
+        avg = (probe.count > 0u) ? (uint16_t)(probe.total / probe.count) : 0u;
+        cap = (avg > 0u) ? (BENCH_CYCLES_PER_S / avg) : 0u;
+        rate = (ticks > 0u) ? ((uint32_t)probe.count * BENCH_TICKS_PER_S / ticks) : 0u;
+        /* Minimal printf: signed 16 bit only */
+        if (cap > 0x7FFFu) cap = 0x7FFFu;
+        if (rate > 0x7FFFu) rate = 0x7FFFu;
+        len = snprintf(msg, size, "BENCH %s [n: %d max: %d avg: %d] [cap/s: %d rate/s: %d]%s\n\r",
+                       BENCH_ProbeName[line],
+                       (int)probe.count,
+                       (int)((probe.max > 0x7FFFu) ? 0x7FFFu : probe.max),
+                       (int)((avg > 0x7FFFu) ? 0x7FFFu : avg),
+                       (int)cap,
+                       (int)rate,
+                       (probe.max > BENCH_Budget[line]) ? " !" : "");
+#else
+        /* Probes compiled out */
+        len = 0;
+#endif
+    }
+    else
+    {
+        uint16_t stackSize = (uint16_t)((&__STACK_END - &_stack) * sizeof(uint16_t));
+        uint16_t stackUsed = BENCH_StackUsed();
+
+        len = snprintf(msg, size, "MEM [stk: %d/%d]%s [bss: %d data: %d] [text: %d isr: %d const: %d pers: %d]\n\r",
+                       (int)stackUsed,
+                       (int)stackSize,
+                       ((uint32_t)stackUsed * 100u > (uint32_t)stackSize * BENCH_STACK_BUDGET_PCT) ? " !" : "",
+                       (int)(uintptr_t)&ram_bss_size,
+                       (int)(uintptr_t)&ram_data_size,
+                       (int)(uintptr_t)&fram_text_size,
+                       (int)(uintptr_t)&fram_isr_size,
+                       (int)(uintptr_t)&fram_const_size,
+                       (int)(uintptr_t)&fram_persistent_size);
+    }
+    return (len > 0) ? (size_t)len : 0u;
+}
+
+/****************************************************************************************
+ * Func name: SMOOTH_init
+ * Descr: Definition for SMOOTH_init. Starts a channel smoother at rest on a compare value
+ * @param: uint8_t channel, uint16_t ccr
+ */
+void SMOOTH_init(uint8_t channel, uint16_t ccr)
+{
+    SMOOTH_State *s = &SMOOTH_Ch[channel];
+
+    s->posQ8 = (int32_t)ccr << 8;
+    s->velQ8 = 0;
+    s->hostVelQ8 = 0;
+    s->target = ccr;
+    s->interpLeft = 0;
+    s->extrapLeft = 0;
+}
+
+/****************************************************************************************
+ * Func name: SMOOTH_newSetpoint
+ * Descr: Definition for SMOOTH_newSetpoint. Interpolates from the current output to the new setpoint over the
+ *        last host interval (so the output arrives as the next setpoint is due) and keeps the host rate for
+ *        extrapolation. Only a streaming host (interval <= SMOOTH_MAX_INTERVAL) is extrapolated.
+ *        Divisions run once per host setpoint, not per period (TB1 ISR context).
+ * @param: uint8_t channel, uint16_t target, uint16_t interval
+ */
+void SMOOTH_newSetpoint(uint8_t channel, uint16_t target, uint16_t interval)
+{
+    SMOOTH_State *s = &SMOOTH_Ch[channel];
+
+    if (interval < 1u) interval = 1u;
+    if (interval > SMOOTH_MAX_INTERVAL)
+    {
+        /* Isolated command (first one or after a pause): no host rate, move to the target and stay there */
+        interval = SMOOTH_MAX_INTERVAL;
+        s->hostVelQ8 = 0;
+        s->extrapLeft = 0;
+    }
+    else
+    {
+        s->hostVelQ8 = (((int32_t)target - (int32_t)s->target) << 8) / (int32_t)interval;
+        s->extrapLeft = SMOOTH_EXTRAP_MAX_TICKS;
+    }
+    s->velQ8 = (((int32_t)target << 8) - s->posQ8) / (int32_t)interval;
+    s->target = target;
+    s->interpLeft = (uint8_t)interval;
+}
+
+/****************************************************************************************
+ * Func name: SMOOTH_step
+ * Descr: Definition for SMOOTH_step. One PWM period: interpolate (lands exactly on the setpoint), then
+ *        extrapolate with the host rate inside the pulse limits; when the horizon runs out without a new
+ *        setpoint, glide back to the last one (TB1 ISR context).
+ * @param: uint8_t channel
+ * @return: compare value
+ */
+uint16_t SMOOTH_step(uint8_t channel)
+{
+    SMOOTH_State *s = &SMOOTH_Ch[channel];
+
+    if (s->interpLeft > 0u)
+    {
+        s->interpLeft--;
+        s->posQ8 = (s->interpLeft > 0u) ? (s->posQ8 + s->velQ8) : ((int32_t)s->target << 8);
+    }
+    else if (s->extrapLeft > 0u)
+    {
+        s->extrapLeft--;
+        s->posQ8 += s->hostVelQ8;
+        if (s->posQ8 < ((int32_t)SERVO_MinCCR[channel] << 8)) s->posQ8 = (int32_t)SERVO_MinCCR[channel] << 8;
+        if (s->posQ8 > ((int32_t)SERVO_MaxCCR[channel] << 8)) s->posQ8 = (int32_t)SERVO_MaxCCR[channel] << 8;
+        /* Host went quiet: return to its last setpoint */
+        if (s->extrapLeft == 0u)
+        {
+            s->velQ8 = (((int32_t)s->target << 8) - s->posQ8) / (int32_t)SMOOTH_EXTRAP_MAX_TICKS;
+            s->interpLeft = SMOOTH_EXTRAP_MAX_TICKS;
+        }
+    }
+    return (uint16_t)(s->posQ8 >> 8);
+}
+
+/****************************************************************************************
+ * Func name: SERVO_slew
+ * Descr: Definition for SERVO_slew. One PWM period step from the current towards the target compare value
+ * @param: uint16_t current, uint16_t target, uint16_t maxStep
+ * @return: next compare value
+ */
+uint16_t SERVO_slew(uint16_t current, uint16_t target, uint16_t maxStep)
+{
+    if (target > current + maxStep)
     {
-        /* Set angle */
-        TB1CCR1 = SG90_0DEG + deg * SG90_1DEG;
+        return current + maxStep;
     }
-    else if(deg >= 90 && deg <= 180)
+    if (current > target + maxStep)
     {
-        /* Set angle */
-        TB1CCR1 = SG90_0DEG - (deg - 90) * SG90_1DEG;
+        return current - maxStep;
     }
+    return target;
 }
 
 /****************************************************************************************
@@ -0,0 +1,77 @@
+/****************************************************************************************
+ * SG90_pid.h
+ *
+ *  Descr: Fixed-point PID for the SG90 position loop. No hardware access, so the same code
+ *         runs in the firmware and in the host test (tests/SG90_pid_test.c).
+ *
+ *
+ */
+#ifndef SG90_PID_H_
+#define SG90_PID_H_
+
+#include <stdint.h>
+
+/*
+ * PID: gains in Q8 (256 = 1.0), output in compare counts
+ */
+#define PID_Q 8
+#define PID_KP_Q8 128
+#define PID_KI_Q8 16
+#define PID_KD_Q8 64
+/* Integrator limit (Q8) and max correction (compare counts) */
+#define PID_INTEG_MAX ((int32_t)200 << PID_Q)
+#define PID_OUT_MAX 300
+
+typedef struct {
+    /* Gains, Q8 */
+    int16_t kp;
+    int16_t ki;
+    int16_t kd;
+    /* Integrator, Q8 */
+    int32_t integ;
+    /* Last measurement, for derivative on measurement */
+    int16_t prevMeas;
+} PID_State;
+
+/****************************************************************************************
+ * Func name: PID_seed
+ * Descr: Bumpless start: derivative from the current measurement, integrator cancels the P term, so the
+ *        first PID_step only adds the I increment.
+ * @param: PID_State *pid, int16_t error, int16_t measurement
+ */
+static inline void PID_seed(PID_State *pid, int16_t error, int16_t measurement)
+{
+    pid->integ = -(int32_t)pid->kp * error;
+    if (pid->integ > PID_INTEG_MAX) pid->integ = PID_INTEG_MAX;
+    if (pid->integ < -PID_INTEG_MAX) pid->integ = -PID_INTEG_MAX;
+    pid->prevMeas = measurement;
+}
+
+/****************************************************************************************
+ * Func name: PID_step
+ * Descr: One fixed-point PID update (Q8 gains, derivative on measurement, clamped integrator).
+ *        Pure function: no hardware access.
+ * @param: PID_State *pid, int16_t error, int16_t measurement
+ * @return: correction in compare counts
+ */
+static inline int16_t PID_step(PID_State *pid, int16_t error, int16_t measurement)
+{
+    int32_t out;
+
+    /* Integrator with anti-windup clamp */
+    pid->integ += (int32_t)pid->ki * error;
+    if (pid->integ > PID_INTEG_MAX) pid->integ = PID_INTEG_MAX;
+    if (pid->integ < -PID_INTEG_MAX) pid->integ = -PID_INTEG_MAX;
+
+    /* P + I - D(measurement): no derivative kick on setpoint steps */
+    out = (int32_t)pid->kp * error + pid->integ - (int32_t)pid->kd * (measurement - pid->prevMeas);
+    pid->prevMeas = measurement;
+    out >>= PID_Q;
+
+    /* Trim the correction */
+    if (out > PID_OUT_MAX) out = PID_OUT_MAX;
+    if (out < -PID_OUT_MAX) out = -PID_OUT_MAX;
+    return (int16_t)out;
+}
+
+#endif /* SG90_PID_H_ */
@@ -129,7 +129,7 @@ SECTIONS
     {
         GROUP(READ_WRITE_MEMORY)
         {
-            .TI.persistent : {}              /* For #pragma persistent            */
+            .TI.persistent : {} SIZE(fram_persistent_size) /* For #pragma persistent */
             .cio           : {}              /* C I/O Buffer                      */
             .sysmem        : {}              /* Dynamic memory allocation area    */
         } PALIGN(0x0400), RUN_START(fram_rw_start) RUN_END(fram_rx_start)
@@ -142,13 +142,13 @@ SECTIONS
             .init_array : {}                   /* C++ constructor tables            */
             .mspabi.exidx : {}                 /* C++ constructor tables            */
             .mspabi.extab : {}                 /* C++ constructor tables            */
-            .const      : {}                   /* Constant data                     */
+            .const      : {} SIZE(fram_const_size) /* Constant data                     */
         }
 
         GROUP(EXECUTABLE_MEMORY)
         {
-            .text       : {}                   /* Code                              */
-            .text:_isr  : {}                   /* Code ISRs                         */
+            .text       : {} SIZE(fram_text_size) /* Code                              */
+            .text:_isr  : {} SIZE(fram_isr_size) /* Code ISRs                         */
         }
     } > FRAM
 
@@ -164,8 +164,8 @@ SECTIONS
     .bslconfig          : {} > BSLCONFIGURATION
     .bsli2caddress      : {} > BSLI2CADDRESS
 
-    .bss        : {} > RAM                  /* Global & static vars              */
-    .data       : {} > RAM                  /* Global & static vars              */
+    .bss        : {} > RAM, SIZE(ram_bss_size)   /* Global & static vars         */
+    .data       : {} > RAM, SIZE(ram_data_size)  /* Global & static vars         */
     .TI.noinit  : {} > RAM                  /* For #pragma noinit                */
     .stack      : {} > RAM (HIGH)           /* Software system stack             */
 
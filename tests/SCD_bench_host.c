@@ -0,0 +1,237 @@
+/****************************************************************************************
+ * SCD_bench_host.c
+ *
+ *  Descr: Host benchmark of the firmware hot paths. The firmware translation unit is built for the host
+ *         against tests/host/msp430.h, so the code measured is the code that ships:
+ *          - cmd: group command parsing, RX queue -> UART_COM_processRx -> commit (commands/s)
+ *          - fmt full / fmt delta: TLM_FormatMessage keyframe and delta lines (frames/s)
+ *          - angle: SG90_setAngle staging (calls/s)
+ *          - tx isr: USCI_A1_ISR sending one queued byte (bytes/s)
+ *          - ctrl isr: Timer_B1_ISR, one PWM period (periods/s)
+ *         Build and run from the repository root:
+ *             gcc -std=c99 -O2 -Wall -Wno-unknown-pragmas -Itests/host -I. tests/SCD_bench_host.c -o SCD_bench_host && ./SCD_bench_host
+ *         Each path runs BENCH_ROUNDS times, the fastest round is reported (least disturbed by the host OS).
+ *         Output lines "HOST <path> [n: .. ns/op: ..] [<unit>/s: ..]" are checked against the baseline by
+ *         tools/resource_report.py --host-bench. Exit code 0 -> every path ran and produced the expected result.
+ *
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+
+/* Firmware under test; its main is not used */
+#define main SCD_firmwareMain
+#include "SCDADMCT_DemoPhaseSingleStructure_mainFIle.c"
+#undef main
+
+/* Linker symbols of the target build (lnk_msp430fr2355.cmd) */
+uint16_t _stack;
+uint16_t __STACK_END;
+uint16_t ram_bss_size;
+uint16_t ram_data_size;
+uint16_t fram_text_size;
+uint16_t fram_isr_size;
+uint16_t fram_const_size;
+uint16_t fram_persistent_size;
+
+#define BENCH_ROUNDS 5
+#define BENCH_NR_OF_CMDS 16u
+
+typedef long (*BENCH_HostFn)(long iterations);
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    long iterations;
+    BENCH_HostFn run;
+} BENCH_HostCase;
+
+static char BENCH_Cmds[BENCH_NR_OF_CMDS][16];
+static char BENCH_Msg[UART_MSG_MAX_LEN];
+
+/****************************************************************************************
+ * Func name: nowNs
+ * Descr: Monotonic time stamp
+ * @return: nanoseconds
+ */
+static double nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/****************************************************************************************
+ * Func name: runCmd
+ * Descr: Feeds group commands through the RX queue and the parser, one command per iteration
+ * @param: long iterations
+ * @return: 0 if every command was committed
+ */
+static long runCmd(long iterations)
+{
+    uint8_t cnt0 = UART_SetpointCmdCnt;
+    long i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        const char *c = BENCH_Cmds[(unsigned long)i % BENCH_NR_OF_CMDS];
+
+        while (*c)
+        {
+            UART_COM_pushRx(*c++);
+        }
+        UART_COM_processRx();
+    }
+    return ((uint8_t)(UART_SetpointCmdCnt - cnt0) == (uint8_t)iterations) ? 0 : 1;
+}
+
+/****************************************************************************************
+ * Func name: runFmt
+ * Descr: Formats one telemetry line per iteration with changing fields
+ * @param: long iterations
+ * @return: 0 if every frame produced a line
+ */
+static long runFmt(long iterations)
+{
+    long empty = 0;
+    long i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        setNrOfDegrees[SERVO_CH0] = (uint8_t)(i % 181);
+        if (TLM_FormatMessage(BENCH_Msg, sizeof(BENCH_Msg)) == 0u)
+        {
+            empty++;
+        }
+    }
+    return empty;
+}
+
+static long runFmtFull(long iterations)
+{
+    TLM_Mode = TLM_MODE_FULL;
+    return runFmt(iterations);
+}
+
+static long runFmtDelta(long iterations)
+{
+    TLM_Mode = TLM_MODE_DELTA;
+    return runFmt(iterations);
+}
+
+/****************************************************************************************
+ * Func name: runAngle
+ * Descr: Stages one channel angle per iteration
+ * @param: long iterations
+ * @return: 0
+ */
+static long runAngle(long iterations)
+{
+    long i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        SG90_setAngle((uint8_t)(i & 1), (uint8_t)(i % 181));
+    }
+    return 0;
+}
+
+/****************************************************************************************
+ * Func name: runTx
+ * Descr: Sends one queued byte per iteration through the TX interrupt; the queue is refilled with full lines
+ * @param: long iterations
+ * @return: 0 if every byte left the queue
+ */
+static long runTx(long iterations)
+{
+    long sent = 0;
+
+    TLM_Mode = TLM_MODE_FULL;
+    UCA1IV = USCI_UART_UCTXIFG;
+    while (sent < iterations)
+    {
+        if (UART_TxTail == UART_TxHead)
+        {
+            TLM_FormatMessage(BENCH_Msg, sizeof(BENCH_Msg));
+            UART_COM_enqueueTx(BENCH_Msg);
+        }
+        USCI_A1_ISR();
+        sent++;
+    }
+    while (UART_TxTail != UART_TxHead)
+    {
+        USCI_A1_ISR();
+    }
+    return 0;
+}
+
+/****************************************************************************************
+ * Func name: runCtrl
+ * Descr: One TB1 period per iteration; a new group is staged every 5 periods (25 Hz host)
+ * @param: long iterations
+ * @return: 0
+ */
+static long runCtrl(long iterations)
+{
+    long i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        if (i % 5 == 0)
+        {
+            SG90_setAngle(SERVO_CH0, (uint8_t)((i / 5) % 91));
+            SG90_setAngle(SERVO_CH1, (uint8_t)(90 + (i / 5) % 91));
+            SERVO_ShadowCmdCnt++;
+            SERVO_ShadowPending = true;
+        }
+        Timer_B1_ISR();
+    }
+    return 0;
+}
+
+static const BENCH_HostCase benchCases[] = {
+    {"cmd", "cmd/s", 200000L, runCmd},
+    {"fmt full", "frames/s", 100000L, runFmtFull},
+    {"fmt delta", "frames/s", 100000L, runFmtDelta},
+    {"angle", "calls/s", 2000000L, runAngle},
+    {"tx isr", "bytes/s", 2000000L, runTx},
+    {"ctrl isr", "periods/s", 500000L, runCtrl},
+};
+
+int main(void)
+{
+    int failed = 0;
+    unsigned int i;
+    int round;
+
+    /* Same start state as the firmware after its init */
+    WDT_InitSupervisor();
+    TB_ConfigureTimerB1();
+    UART_RxTimeoutTicks = 0;
+    for (i = 0; i < BENCH_NR_OF_CMDS; i++)
+    {
+        snprintf(BENCH_Cmds[i], sizeof(BENCH_Cmds[i]), "G%u,%u,%u\r", i, (i * 11u) % 181u, 180u - (i * 7u) % 181u);
+    }
+
+    for (i = 0; i < sizeof(benchCases) / sizeof(benchCases[0]); i++)
+    {
+        const BENCH_HostCase *bc = &benchCases[i];
+        double best = 0.0;
+        long errors = 0;
+
+        for (round = 0; round < BENCH_ROUNDS; round++)
+        {
+            double t0 = nowNs();
+            double ns;
+
+            errors += bc->run(bc->iterations);
+            ns = (nowNs() - t0) / (double)bc->iterations;
+            if (round == 0 || ns < best) best = ns;
+        }
+        printf("HOST %s [n: %ld ns/op: %.1f] [%s: %.0f]%s\n", bc->name, bc->iterations, best, bc->unit,
+               (best > 0.0) ? 1e9 / best : 0.0, (errors != 0) ? " FAIL" : "");
+        if (errors != 0) failed++;
+    }
+    return (failed != 0) ? 1 : 0;
+}
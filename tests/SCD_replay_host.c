@@ -0,0 +1,266 @@
+/****************************************************************************************
+ * SCD_replay_host.c
+ *
+ *  Descr: Host replay driver. Feeds a serial capture dump ("D1", framing see TLOG_Dump) into the firmware built
+ *         for the host (tests/host/msp430.h) at its original timing, one TB1 period per step, and writes the
+ *         resulting telemetry log in the "D0" dump framing. The traces are then compared with
+ *         tools/trace_diff.py, against the log of the original session or a committed host reference:
+ *             gcc -std=c99 -O2 -Wall -Wno-unknown-pragmas -Itests/host -I. tests/SCD_replay_host.c -o SCD_replay_host
+ *             ./SCD_replay_host capture.bin replay.bin [settle periods]
+ *         Main loop model per period: Timer_B1_ISR, parser, TX drain, group staging.
+ *         Exit code 0 -> replayed, 1 -> replay did not fit the log, 2 -> input error.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* Firmware under test; its main is not used */
+#define main SCD_firmwareMain
+#include "SCDADMCT_DemoPhaseSingleStructure_mainFIle.c"
+#undef main
+
+/* Linker symbols of the target build (lnk_msp430fr2355.cmd) */
+uint16_t _stack;
+uint16_t __STACK_END;
+uint16_t ram_bss_size;
+uint16_t ram_data_size;
+uint16_t fram_text_size;
+uint16_t fram_isr_size;
+uint16_t fram_const_size;
+uint16_t fram_persistent_size;
+
+/* Periods run after the last replayed byte, so the final motion is in the log */
+#define REPLAY_SETTLE_PERIODS 100u
+/* Largest dump file accepted: full capture plus framing and the announce line */
+#define REPLAY_MAX_DUMP (SCAP_NR_OF_RECORDS * sizeof(SCAP_Record) * 2u)
+
+static uint8_t REPLAY_Dump[REPLAY_MAX_DUMP];
+
+/****************************************************************************************
+ * Func name: loadCapture
+ * Descr: Reads a "SCAP" dump into the capture buffer; anything before the header (announce line) is skipped.
+ *        Checks record size, block markers, checksums and the trailer.
+ * @param: const char *path
+ * @return: 0 ok, else error
+ */
+static int loadCapture(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    size_t len;
+    size_t pos;
+    uint16_t count;
+    uint16_t idx = 0;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    len = fread(REPLAY_Dump, 1, sizeof(REPLAY_Dump), f);
+    fclose(f);
+
+    /* Header: magic and record size (the announce line names the magic too) */
+    for (pos = 0; pos + 7u <= len; pos++)
+    {
+        if (memcmp(&REPLAY_Dump[pos], "SCAP", 4) == 0 && REPLAY_Dump[pos + 4u] == sizeof(SCAP_Record))
+        {
+            break;
+        }
+    }
+    if (pos + 7u > len)
+    {
+        fprintf(stderr, "%s: no SCAP dump header\n", path);
+        return 1;
+    }
+    count = (uint16_t)(REPLAY_Dump[pos + 5u] | (REPLAY_Dump[pos + 6u] << 8));
+    pos += 7u;
+    if (count > SCAP_NR_OF_RECORDS)
+    {
+        fprintf(stderr, "%s: %u records, capture holds %u\n", path, count, SCAP_NR_OF_RECORDS);
+        return 1;
+    }
+
+    while (idx < count)
+    {
+        uint8_t n;
+        uint8_t checksum = 0;
+        size_t i;
+
+        if (pos + 2u > len || REPLAY_Dump[pos] != TLOG_DUMP_BLOCK_ID)
+        {
+            fprintf(stderr, "%s: block %u missing\n", path, idx / TLOG_DUMP_BLOCK);
+            return 1;
+        }
+        n = REPLAY_Dump[pos + 1u];
+        pos += 2u;
+        if (n == 0u || idx + n > count || pos + n * sizeof(SCAP_Record) + 1u > len)
+        {
+            fprintf(stderr, "%s: block %u truncated\n", path, idx / TLOG_DUMP_BLOCK);
+            return 1;
+        }
+        for (i = 0; i < n * sizeof(SCAP_Record); i++)
+        {
+            checksum ^= REPLAY_Dump[pos + i];
+        }
+        if (checksum != REPLAY_Dump[pos + n * sizeof(SCAP_Record)])
+        {
+            fprintf(stderr, "%s: block %u checksum\n", path, idx / TLOG_DUMP_BLOCK);
+            return 1;
+        }
+        while (n--)
+        {
+            /* Little endian on the wire, whatever the host */
+            SCAP_Buff[idx].tick = (uint16_t)(REPLAY_Dump[pos] | (REPLAY_Dump[pos + 1u] << 8));
+            SCAP_Buff[idx].dir = REPLAY_Dump[pos + 2u];
+            SCAP_Buff[idx].data = REPLAY_Dump[pos + 3u];
+            pos += sizeof(SCAP_Record);
+            idx++;
+        }
+        pos++;
+    }
+    if (pos + 4u > len || memcmp(&REPLAY_Dump[pos], "TEND", 4) != 0)
+    {
+        fprintf(stderr, "%s: no trailer\n", path);
+        return 1;
+    }
+
+    SCAP_Count = count;
+    SCAP_Head = (count < SCAP_NR_OF_RECORDS) ? count : 0u;
+    return 0;
+}
+
+/****************************************************************************************
+ * Func name: putLe16
+ * Descr: Appends a 16 bit value little endian and folds it into the block checksum
+ * @param: FILE *f, uint16_t value, uint8_t *checksum
+ */
+static void putLe16(FILE *f, uint16_t value, uint8_t *checksum)
+{
+    fputc(value & 0xFFu, f);
+    fputc(value >> 8, f);
+    *checksum ^= (uint8_t)(value & 0xFFu) ^ (uint8_t)(value >> 8);
+}
+
+/****************************************************************************************
+ * Func name: putU8
+ * Descr: Appends a byte and folds it into the block checksum
+ * @param: FILE *f, uint8_t value, uint8_t *checksum
+ */
+static void putU8(FILE *f, uint8_t value, uint8_t *checksum)
+{
+    fputc(value, f);
+    *checksum ^= value;
+}
+
+/****************************************************************************************
+ * Func name: writeLog
+ * Descr: Writes the telemetry log, oldest sample first, in the "TLOG" dump framing
+ * @param: const char *path
+ * @return: 0 ok, else error
+ */
+static int writeLog(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    uint16_t idx = (TLOG_Head + TLOG_NR_OF_SAMPLES - TLOG_Count) % TLOG_NR_OF_SAMPLES;
+    uint16_t left = TLOG_Count;
+    uint8_t unused = 0;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return 1;
+    }
+    fwrite("TLOG", 1, 4, f);
+    putU8(f, (uint8_t)sizeof(TLOG_Sample), &unused);
+    putLe16(f, left, &unused);
+    while (left > 0u)
+    {
+        uint8_t n = (left > TLOG_DUMP_BLOCK) ? TLOG_DUMP_BLOCK : (uint8_t)left;
+        uint8_t checksum = 0;
+
+        fputc(TLOG_DUMP_BLOCK_ID, f);
+        fputc(n, f);
+        left -= n;
+        while (n--)
+        {
+            const TLOG_Sample *s = &TLOG_Buff[idx];
+
+            putLe16(f, s->tick, &checksum);
+            putLe16(f, s->ccr[SERVO_CH0], &checksum);
+            putLe16(f, s->ccr[SERVO_CH1], &checksum);
+            putU8(f, s->deg[SERVO_CH0], &checksum);
+            putU8(f, s->deg[SERVO_CH1], &checksum);
+            putU8(f, s->seq, &checksum);
+            putU8(f, s->flags, &checksum);
+            putLe16(f, s->fb, &checksum);
+            idx = (idx + 1u < TLOG_NR_OF_SAMPLES) ? (idx + 1u) : 0u;
+        }
+        fputc(checksum, f);
+    }
+    fwrite("TEND", 1, 4, f);
+    return (fclose(f) == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long settle = REPLAY_SETTLE_PERIODS;
+    unsigned long periods = 0;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s capture.bin replay.bin [settle periods]\n", argv[0]);
+        return 2;
+    }
+    if (argc > 3)
+    {
+        settle = strtoul(argv[3], NULL, 0);
+    }
+
+    /* Firmware state after its init (main), without the calibration sweep */
+    UART_CmdId = UART_CMD_NONE;
+    UART_RxTimeoutTicks = UART_RX_TIMEOUT_TICKS;
+    TLM_Mode = TLM_MODE_FULL;
+    TLM_RateHz = TB0_DELAY_SECONDS;
+    TLM_KeyframeRequest = true;
+    WDT_InitSupervisor();
+    TB_ConfigureTimerB1();
+    TLOG_Head = 0;
+    TLOG_Count = 0;
+
+    if (loadCapture(argv[1]) != 0)
+    {
+        return 2;
+    }
+
+    /* Same entry as a "P1" command */
+    SCAP_StartReplay(1u);
+    UCA1IV = USCI_UART_UCTXIFG;
+    while (SCAP_Replaying || settle > 0u)
+    {
+        if (!SCAP_Replaying)
+        {
+            settle--;
+        }
+        Timer_B1_ISR();
+        UART_COM_processRx();
+        while (UART_TxTail != UART_TxHead)
+        {
+            USCI_A1_ISR();
+        }
+        SERVO_StageGroup();
+        periods++;
+    }
+
+    if (writeLog(argv[2]) != 0)
+    {
+        return 2;
+    }
+    printf("replayed %u records in %lu periods\n", SCAP_Count, periods);
+    if (periods > TLOG_NR_OF_SAMPLES)
+    {
+        fprintf(stderr, "replay ran %lu periods, the log keeps the last %u\n", periods, TLOG_NR_OF_SAMPLES);
+        return 1;
+    }
+    return 0;
+}
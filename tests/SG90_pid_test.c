@@ -0,0 +1,146 @@
+/****************************************************************************************
+ * SG90_pid_test.c
+ *
+ *  Descr: Host test for PID_step against a first-order servo plant, run once per 20 ms PWM period.
+ *         Build and run from the repository root:
+ *             gcc -std=c99 -Wall -I. tests/SG90_pid_test.c -o SG90_pid_test && ./SG90_pid_test
+ *         Exit code 0 -> all cases pass.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "SG90_pid.h"
+
+/*
+ * Plant: the servo follows the driven pulse with a first-order lag; the load holds it short of the
+ * command by a fixed offset. Position in compare counts (1 count = 1 us).
+ */
+#define PLANT_TAU_Q8 77      /* 0.3 per period -> ~60 ms time constant */
+#define PLANT_MIN 760
+#define PLANT_MAX 2740
+#define PERIODS_PER_S 50
+
+/* Settle band and time */
+#define SETTLE_BAND 2
+#define SETTLE_PERIODS (3 * PERIODS_PER_S)
+
+typedef struct {
+    const char *name;
+    int16_t start;
+    int16_t target;
+    /* Steady state error of the open loop plant (load) */
+    int16_t loadOffset;
+} PID_TestCase;
+
+static const PID_TestCase testCases[] = {
+    {"0 -> +45 deg, no load", 1750, 2245, 0},
+    {"0 -> +45 deg, 80 counts load", 1750, 2245, 80},
+    {"+90 -> -80 deg, -80 counts load", 2740, 870, -80},
+    {"-45 -> 0 deg, 150 counts load", 1255, 1750, 150},
+};
+
+/****************************************************************************************
+ * Func name: runCase
+ * Descr: Closes the loop for SETTLE_PERIODS + 1 s; checks settle time, overshoot and the final error
+ * @param: const PID_TestCase *tc
+ * @return: 0 on pass
+ */
+static int runCase(const PID_TestCase *tc)
+{
+    PID_State pid = {PID_KP_Q8, PID_KI_Q8, PID_KD_Q8, 0, 0};
+    int32_t posQ8 = (int32_t)tc->start << 8;
+    int16_t step = (int16_t)(tc->target - tc->start);
+    int16_t maxOvershoot = 0;
+    int settledAt = -1;
+    int k;
+
+    pid.prevMeas = tc->start;
+    for (k = 0; k < SETTLE_PERIODS + PERIODS_PER_S; k++)
+    {
+        int16_t measured = (int16_t)(posQ8 >> 8);
+        int16_t drive = (int16_t)(tc->target + PID_step(&pid, (int16_t)(tc->target - measured), measured));
+        int16_t err;
+        int16_t overshoot;
+
+        /* Same clamp as SG90_closedLoopCCR */
+        if (drive < PLANT_MIN) drive = PLANT_MIN;
+        if (drive > PLANT_MAX) drive = PLANT_MAX;
+        posQ8 += ((((int32_t)drive - tc->loadOffset) << 8) - posQ8) * PLANT_TAU_Q8 >> 8;
+
+        measured = (int16_t)(posQ8 >> 8);
+        err = (int16_t)(tc->target - measured);
+        overshoot = (step > 0) ? (int16_t)-err : err;
+        if (overshoot > maxOvershoot) maxOvershoot = overshoot;
+        if (err > SETTLE_BAND || err < -SETTLE_BAND)
+        {
+            settledAt = -1;
+        }
+        else if (settledAt < 0)
+        {
+            settledAt = k;
+        }
+    }
+
+    printf("%-32s settled: %4d periods  overshoot: %3d  final error: %3d  ",
+           tc->name, settledAt, maxOvershoot, (int)(tc->target - (posQ8 >> 8)));
+    if (settledAt < 0 || settledAt > SETTLE_PERIODS)
+    {
+        printf("FAIL (settle)\n");
+        return 1;
+    }
+    /* Overshoot limit: 10% of the step */
+    if (maxOvershoot * 10 > (step > 0 ? step : -step))
+    {
+        printf("FAIL (overshoot)\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
+
+/* Handover from calibration: measured position next to the 0 deg target */
+static const int16_t seedOffsets[] = {0, 20, -20, 100, -100};
+
+/****************************************************************************************
+ * Func name: runSeedCase
+ * Descr: First PID_step after PID_seed must not kick: only the I increment of the first error is allowed
+ * @param: int16_t offset (measured - target)
+ * @return: 0 on pass
+ */
+static int runSeedCase(int16_t offset)
+{
+    PID_State pid = {PID_KP_Q8, PID_KI_Q8, PID_KD_Q8, 0, 0};
+    int16_t target = 1750;
+    int16_t measured = (int16_t)(target + offset);
+    int16_t error = (int16_t)(target - measured);
+    int16_t limit = (int16_t)(((int32_t)PID_KI_Q8 * (error > 0 ? error : -error) >> PID_Q) + 1);
+    int16_t out;
+
+    PID_seed(&pid, error, measured);
+    out = PID_step(&pid, error, measured);
+    printf("seed, measured %+4d from target     first output: %4d  ", offset, out);
+    if (out > limit || out < -limit)
+    {
+        printf("FAIL (kick)\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(testCases) / sizeof(testCases[0]); i++)
+    {
+        failed += runCase(&testCases[i]);
+    }
+    for (i = 0; i < sizeof(seedOffsets) / sizeof(seedOffsets[0]); i++)
+    {
+        failed += runSeedCase(seedOffsets[i]);
+    }
+    return (failed != 0) ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+/****************************************************************************************
+ * msp430.h (host)
+ *
+ *  Descr: Host stand-in for the TI device header, so the firmware translation unit builds with gcc for the
+ *         host benchmark (tests/SCD_bench_host.c). Registers are plain variables, intrinsics do nothing.
+ *         Bit values follow the MSP430FR2355 header where the firmware logic depends on them; the rest only
+ *         has to exist. Include it from a single translation unit (it defines the registers).
+ *
+ */
+#ifndef MSP430_HOST_H_
+#define MSP430_HOST_H_
+
+#include <stdint.h>
+
+#define HOST_REG16(name) volatile uint16_t name;
+#define HOST_REG8(name) volatile uint8_t name;
+
+/* Watchdog, clock system, power management */
+HOST_REG16(WDTCTL) HOST_REG16(SFRIE1) HOST_REG16(SYSRSTIV) HOST_REG16(PM5CTL0) HOST_REG16(FRCTL0)
+HOST_REG16(CSCTL0) HOST_REG16(CSCTL1) HOST_REG16(CSCTL2) HOST_REG16(CSCTL3) HOST_REG16(CSCTL4) HOST_REG16(CSCTL5)
+/* Timer B0 / B1 / B2 */
+HOST_REG16(TB0CTL) HOST_REG16(TB0CCTL0) HOST_REG16(TB0CCR0)
+HOST_REG16(TB1CTL) HOST_REG16(TB1R) HOST_REG16(TB1CCTL0) HOST_REG16(TB1CCTL1) HOST_REG16(TB1CCTL2)
+HOST_REG16(TB1CCR0) HOST_REG16(TB1CCR1) HOST_REG16(TB1CCR2)
+HOST_REG16(TB2CTL) HOST_REG16(TB2R)
+/* eUSCI_A1 UART */
+HOST_REG16(UCA1CTLW0) HOST_REG16(UCA1MCTLW) HOST_REG16(UCA1STATW) HOST_REG16(UCA1RXBUF) HOST_REG16(UCA1TXBUF)
+HOST_REG16(UCA1IE) HOST_REG16(UCA1IFG) HOST_REG16(UCA1IV) HOST_REG8(UCA1BR0) HOST_REG8(UCA1BR1)
+/* ADC */
+HOST_REG16(ADCCTL0) HOST_REG16(ADCCTL1) HOST_REG16(ADCCTL2) HOST_REG16(ADCMCTL0) HOST_REG16(ADCIE) HOST_REG16(ADCIV)
+HOST_REG16(ADCMEM0)
+/* Ports */
+HOST_REG8(P1DIR) HOST_REG8(P1OUT) HOST_REG8(P1SEL0) HOST_REG8(P1SEL1) HOST_REG8(P2DIR) HOST_REG8(P2SEL0)
+HOST_REG8(P2SEL1) HOST_REG8(P4SEL0) HOST_REG8(P6DIR) HOST_REG8(P6OUT)
+
+enum {
+    BIT0 = 0x01, BIT1 = 0x02, BIT2 = 0x04, BIT3 = 0x08, BIT4 = 0x10, BIT5 = 0x20, BIT6 = 0x40, BIT7 = 0x80,
+    /* WDT */
+    WDTPW = 0x5A00, WDTHOLD_0 = 0x0000, WDTSSEL__SMCLK = 0x0000, WDTSSEL__ACLK = 0x0020, WDTTMSEL_0 = 0x0000,
+    WDTTMSEL_1 = 0x0010, WDTCNTCL_1 = 0x0008, WDTIS_2 = 0x0002, WDTIS_4 = 0x0004, WDTIE = 0x0001,
+    SYSRSTIV_NONE = 0x0000, SYSRSTIV_WDTTO = 0x0016,
+    /* Clock system, FRAM, power management */
+    LOCKLPM5 = 0x0001, FRCTLPW = 0xA500, NWAITS_2 = 0x0020, SCG0 = 0x0040, SELREF__REFOCLK = 0x0010,
+    FLLREFDIV_0 = 0x0000, DCOFTRIMEN_1 = 0x0080, DCOFTRIM0 = 0x0010, DCOFTRIM1 = 0x0020, DCORSEL_5 = 0x000A,
+    FLLD_0 = 0x0000, SELMS__DCOCLKDIV = 0x0000, SELA__REFOCLK = 0x0100, DIVM__16 = 0x0004, DIVS_0 = 0x0000,
+    /* Timer B */
+    TBSSEL__ACLK = 0x0100, TBSSEL_2 = 0x0200, MC_1 = 0x0010, MC__UP = 0x0010, MC__CONTINUOUS = 0x0020,
+    TBCLR = 0x0004, CCIE = 0x0010, CCIFG = 0x0001, OUTMOD_7 = 0x00E0, CLLD_1 = 0x0200,
+    /* eUSCI_A UART */
+    UCSWRST = 0x0001, UCRXEIE = 0x0020, UCSSEL_1 = 0x0040, UCSSEL__SMCLK = 0x0080, UCSSEL_3 = 0x00C0,
+    UCBUSY = 0x0001, UCOE = 0x0020, UCFE = 0x0040, UCRXIE = 0x0001, UCTXIE = 0x0002, UCTXIFG = 0x0002,
+    USCI_NONE = 0x00, USCI_UART_UCRXIFG = 0x02, USCI_UART_UCTXIFG = 0x04, USCI_UART_UCSTTIFG = 0x06,
+    USCI_UART_UCTXCPTIFG = 0x08,
+    /* ADC */
+    ADCSHT_2 = 0x0200, ADCON = 0x0010, ADCENC = 0x0002, ADCSHP = 0x0200, ADCSHS_1 = 0x0400, ADCCONSEQ_2 = 0x0004,
+    ADCRES_2 = 0x0020, ADCINCH_5 = 0x0005, ADCIE0 = 0x0001, ADCIV_NONE = 0x00, ADCIV_ADCIFG = 0x0C
+};
+
+/* Compiler intrinsics and keywords */
+#define __interrupt
+#define __even_in_range(value, bound) (value)
+#define __disable_interrupt() ((void)0)
+#define __enable_interrupt() ((void)0)
+#define __delay_cycles(cycles) ((void)0)
+#define __bis_SR_register(bits) ((void)0)
+#define __bic_SR_register(bits) ((void)0)
+#define __get_SP_register() ((uintptr_t)0)
+
+#endif /* MSP430_HOST_H_ */
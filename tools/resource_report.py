@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+"""
+resource_report.py
+
+ Descr: Resource budget report for the CCS build in Debug/. Fails (exit code 1) when a budget is exceeded
+        or a value regressed against the recorded baseline.
+        Inputs:
+         - linkInfo XML (--xml_link_info): memory area usage and section sizes
+         - call graph (optional): worst-case stack per function from the cg_xml call_graph tool, run on the
+           linked image:
+               ofd430 -g -x --xml_indent=0 Debug/SCDADMCT_DemoPhaseSingleStrucuture.out | call_graph > Debug/call_graph.txt
+         - bench log (optional): "B" report lines captured from the UART with BENCH_ENABLE=1u
+         - host bench log (optional): output of tests/SCD_bench_host.c, ns per operation of the hot paths
+        Budgets and baseline: tools/resource_budget.json. Every value is checked against its baseline; a value
+        without baseline is reported as a warning only. --update-baseline records the current values once a
+        change is accepted.
+
+        python3 tools/resource_report.py [--call-graph Debug/call_graph.txt] [--bench bench.log]
+                                         [--host-bench host.log] [--update-baseline]
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_LINK_INFO = os.path.join(ROOT, "Debug", "SCDADMCT_DemoPhaseSingleStrucuture_linkInfo.xml")
+DEFAULT_BUDGET = os.path.join(ROOT, "tools", "resource_budget.json")
+
+# Hardware interrupt frame: PC + SR pushed before the ISR runs (MSP430X, 20 bit PC)
+ISR_FRAME_BYTES = 4
+# Vector table entries and debug info are not part of the image budget
+SKIP_SECTION = re.compile(r"^\.(int\d+|debug_\w+|reset)$")
+ISR_SECTION = re.compile(r"^\.text:_isr:(\w+)$")
+# cg_xml call_graph: "<function> : wcs = <bytes>"; callees are indented with '|'
+CALL_GRAPH_LINE = re.compile(r"^([A-Za-z_$][\w$]*)\s*:\s*wcs\s*=\s*(\d+)")
+BENCH_LINE = re.compile(r"BENCH (.+?) \[n: (\d+) max: (\d+) avg: (\d+)\] \[cap/s: (\d+)(?: rate/s: (\d+))?\]( !)?")
+HOST_LINE = re.compile(r"^HOST (.+?) \[n: (\d+) ns/op: ([\d.]+)\] \[([\w/]+): (\d+)\]( FAIL)?")
+MEM_LINE = re.compile(r"MEM \[stk: (\d+)/(\d+)\]( !)?")
+
+
+def parse_link_info(path):
+    """Memory areas (length, used), output section sizes, ISR names and the entry point."""
+    root = ET.parse(path).getroot()
+    areas = {}
+    for area in root.find("placement_map").findall("memory_area"):
+        areas[area.findtext("name")] = (int(area.findtext("length"), 0), int(area.findtext("used_space"), 0))
+    sections = {}
+    for group in root.find("logical_group_list").findall("logical_group"):
+        name = group.findtext("name")
+        size = int(group.findtext("size", "0"), 0)
+        if name.startswith(".") and size > 0 and not SKIP_SECTION.match(name):
+            sections[name] = size
+    isrs = []
+    for comp in root.find("object_component_list").findall("object_component"):
+        match = ISR_SECTION.match(comp.findtext("name", ""))
+        if match and not match.group(1).startswith("__TI_"):
+            isrs.append(match.group(1))
+    # The reset handler is placed in .text:_isr too; it is the main context, not an ISR
+    entry = root.findtext("entry_point/name")
+    return areas, sections, sorted(set(isrs) - {entry}), entry
+
+
+def parse_call_graph(path):
+    """Worst-case stack (bytes) of every root function listed by call_graph."""
+    wcs = {}
+    with open(path) as f:
+        for line in f:
+            match = CALL_GRAPH_LINE.match(line)
+            if match:
+                name, depth = match.group(1), int(match.group(2))
+                wcs[name] = max(depth, wcs.get(name, 0))
+    return wcs
+
+
+def parse_bench(path):
+    """Worst case per probe over all reports in the log, probes flagged by the firmware, stack high-water mark."""
+    worst = {}
+    flagged = set()
+    stack = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = BENCH_LINE.search(line)
+            if match:
+                name, count, cycles = match.group(1), int(match.group(2)), int(match.group(3))
+                if count > 0:
+                    worst[name] = max(cycles, worst.get(name, 0))
+                if match.group(7):
+                    flagged.add(name)
+                continue
+            match = MEM_LINE.search(line)
+            if match:
+                used = int(match.group(1))
+                stack = used if stack is None else max(stack, used)
+                if match.group(3):
+                    flagged.add("stk")
+    return worst, flagged, stack
+
+
+def parse_host_bench(path):
+    """ns per operation of every host bench path, paths that failed their result check."""
+    ns = {}
+    failed = set()
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = HOST_LINE.match(line)
+            if match:
+                ns[match.group(1)] = float(match.group(3))
+                if match.group(6):
+                    failed.add(match.group(1))
+    return ns, failed
+
+
+class Report:
+    def __init__(self, budget):
+        self.budget = budget
+        self.baseline = budget.get("baseline", {})
+        self.tolerance = budget.get("tolerance_pct", {})
+        self.current = {}
+        self.failures = []
+        self.warnings = []
+        self.lines = []
+
+    def check(self, kind, name, value, limit=None, unit="B"):
+        """Records a metric; flags it above its budget or above the baseline + tolerance of its kind."""
+        key = "%s:%s" % (kind, name)
+        self.current[key] = value
+        notes = []
+        if limit is not None and value > limit:
+            notes.append("over budget %d" % limit)
+            self.failures.append("%s %d%s > budget %d%s" % (key, value, unit, limit, unit))
+        fmt = "%.1f" if isinstance(value, float) else "%d"
+        base = self.baseline.get(key)
+        if base is None:
+            # Nothing to compare against yet: budgets still apply, record it with --update-baseline
+            notes.append("no baseline")
+            self.warnings.append(("%s " + fmt + "%s has no baseline") % (key, value, unit))
+        elif value * 100 > base * (100 + self.tolerance.get(kind, 0)):
+            notes.append(("regressed from " + fmt) % base)
+            self.failures.append(("%s " + fmt + "%s > baseline " + fmt + "%s (+%d%%)") % (
+                key, value, unit, base, unit, self.tolerance.get(kind, 0)))
+        elif value < base:
+            notes.append(("was " + fmt) % base)
+        self.lines.append(("  %-28s %7" + fmt[1:] + " %-6s %s") % (name, value, unit, ", ".join(notes)))
+
+    def section(self, title):
+        self.lines.append(title)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware resource budget report")
+    parser.add_argument("--link-info", default=DEFAULT_LINK_INFO, help="linker --xml_link_info output")
+    parser.add_argument("--call-graph", help="cg_xml call_graph output for the linked image")
+    parser.add_argument("--bench", help="UART log with 'B' reports (BENCH_ENABLE=1u)")
+    parser.add_argument("--host-bench", help="output of the host benchmark tests/SCD_bench_host.c")
+    parser.add_argument("--budget", default=DEFAULT_BUDGET, help="budget and baseline file")
+    parser.add_argument("--update-baseline", action="store_true", help="record the current values as baseline")
+    args = parser.parse_args()
+
+    try:
+        with open(args.budget) as f:
+            budget = json.load(f)
+        areas, sections, isrs, entry = parse_link_info(args.link_info)
+    except (OSError, ValueError, ET.ParseError, AttributeError) as err:
+        print("resource_report: %s" % err, file=sys.stderr)
+        return 2
+
+    report = Report(budget)
+
+    report.section("Memory areas (used / length)")
+    for name, pct in sorted(budget.get("memory_budget_pct", {}).items()):
+        if name not in areas:
+            report.failures.append("memory area %s not in %s" % (name, args.link_info))
+            continue
+        length, used = areas[name]
+        report.check("area", name, used, length * pct // 100)
+
+    report.section("Sections")
+    for name, size in sorted(sections.items()):
+        report.check("section", name, size)
+
+    stack_size = sections.get(".stack", 0)
+    if args.call_graph:
+        wcs = parse_call_graph(args.call_graph)
+        isr_budget = budget.get("isr_stack", {})
+        worst_isr = 0
+        report.section("Worst-case stack per ISR (call graph + %d B interrupt frame)" % ISR_FRAME_BYTES)
+        for isr in isrs:
+            if isr not in wcs:
+                report.failures.append("ISR %s not in %s" % (isr, args.call_graph))
+                continue
+            depth = wcs[isr] + ISR_FRAME_BYTES
+            worst_isr = max(worst_isr, depth)
+            report.check("isr_stack", isr, depth, isr_budget.get(isr, budget.get("isr_stack_default")))
+
+        # ISRs do not nest (GIE stays clear in every ISR): main context + deepest ISR
+        report.section("Worst-case stack, total")
+        if entry not in wcs:
+            report.failures.append("entry point %s not in %s" % (entry, args.call_graph))
+        else:
+            report.check("stack", entry, wcs[entry])
+            report.check("stack", "total", wcs[entry] + worst_isr,
+                         stack_size * budget.get("stack_budget_pct", 100) // 100)
+
+    if args.bench:
+        worst, flagged, stack = parse_bench(args.bench)
+        if not worst and stack is None:
+            report.failures.append("no B report in %s" % args.bench)
+        report.section("Bench, worst case (cycles)")
+        for name, cycles in sorted(worst.items()):
+            report.check("bench", name, cycles, unit="cyc")
+        if stack is not None:
+            report.check("bench", "stk", stack)
+        for name in sorted(flagged):
+            report.failures.append("bench %s flagged over budget by the firmware" % name)
+
+    if args.host_bench:
+        ns, failed = parse_host_bench(args.host_bench)
+        if not ns:
+            report.failures.append("no HOST line in %s" % args.host_bench)
+        report.section("Host bench (ns per operation)")
+        for name, value in sorted(ns.items()):
+            report.check("host", name, value, unit="ns")
+        for name in sorted(failed):
+            report.failures.append("host %s failed its result check" % name)
+
+    print("\n".join(report.lines))
+
+    if args.update_baseline:
+        baseline = dict(report.baseline)
+        baseline.update(report.current)
+        budget["baseline"] = dict(sorted(baseline.items()))
+        with open(args.budget, "w") as f:
+            json.dump(budget, f, indent=4)
+            f.write("\n")
+        print("baseline updated: %s" % args.budget)
+        # Budgets still apply to a new baseline
+        report.failures = [msg for msg in report.failures if "baseline" not in msg]
+        report.warnings = []
+
+    if report.warnings:
+        print("\nWARNING")
+        for msg in report.warnings:
+            print("  " + msg)
+    if report.failures:
+        print("\nFAIL")
+        for msg in report.failures:
+            print("  " + msg)
+        return 1
+    print("\nok")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
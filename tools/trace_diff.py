@@ -0,0 +1,327 @@
+#!/usr/bin/env python3
+"""
+trace_diff.py
+
+ Descr: Host side of the serial capture / replay (C, P, D commands). Decodes the FRAM dumps and diffs the PWM
+        compare and telemetry traces of a replay against a reference.
+        Dump framing (TLOG_Dump): "TLOG"/"SCAP" | record size | count (LE16) | blocks of
+        ['B' | n | n records | XOR checksum] | "TEND". Anything before the magic (the "DUMP ..." announce line of
+        a raw serial log) is skipped. The file is memory mapped; the records are joined into one little endian
+        array (--raw) that numpy.memmap or struct.iter_unpack read directly.
+        Records:
+         - TLOG (12 B): tick, ccr0, ccr1 (LE16), deg0, deg1, seq, flags (u8), fb (LE16)
+         - SCAP (4 B): tick (LE16), dir (1 RX, 2 TX, 4 start state), data (u8)
+        Traces: compare = ccr0/ccr1 per PWM period, telemetry = the reported fields per period (deg0/deg1
+        setpoints, seq, fb). Traces are aligned on the first period of the capture (flags bit 0, original session)
+        or of the replay (flags bit 1), +-2 periods for the replay clock; replay at speed 1 ("P1") only.
+
+        python3 tools/trace_diff.py decode dump.bin [--csv] [--raw records.bin]
+        python3 tools/trace_diff.py diff reference.bin replay.bin [--ccr-tol N] [--fb-tol N]
+        python3 tools/trace_diff.py capture script.txt capture.bin
+        python3 tools/trace_diff.py replay --driver ./SCD_replay_host tests/replay/*.scap [--update]
+
+        capture: builds a capture dump from a script, for replay cases written by hand. Lines: "<tick> <command>"
+        (tick = TB1 period after the capture start, command sent with "\\r"), optional first line
+        "state <deg0> <deg1> <seq> <tlm mode> <tlm rate>", "#" comments.
+        replay: runs every capture through the host replay driver (tests/SCD_replay_host.c) and diffs the log
+        against the reference next to it (<name>.tlog); --update writes the references.
+        Exit code: 0 same traces, 1 traces differ, 2 input error.
+"""
+
+import argparse
+import mmap
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+BLOCK_ID = ord("B")
+TRAILER = b"TEND"
+FORMATS = {
+    b"TLOG": ("<HHHBBBBH", ("tick", "ccr0", "ccr1", "deg0", "deg1", "seq", "flags", "fb")),
+    b"SCAP": ("<HBB", ("tick", "dir", "data")),
+}
+# TLOG_Sample flags
+FLAG_CAPTURE = 0x01
+FLAG_REPLAY = 0x02
+# SCAP_Record dir / start state fields (SCAP_SaveState)
+SCAP_RX = 1
+SCAP_STATE = 4
+STATE_FIELDS = ("deg0", "deg1", "seq", "tlm_mode", "tlm_rate")
+STATE_DEFAULT = (0, 0, 0, 0, 4)
+# Dump block size of the firmware (TLOG_DUMP_BLOCK)
+DUMP_BLOCK = 32
+# Replay clock vs. capture: records pushed at most this many periods off
+ALIGN_SLACK = 2
+# Traces compared per field: (name, tolerance option)
+COMPARE = (("ccr0", "ccr_tol"), ("ccr1", "ccr_tol"))
+TELEMETRY = (("deg0", None), ("deg1", None), ("seq", None), ("fb", "fb_tol"))
+
+
+class DumpError(Exception):
+    pass
+
+
+class Dump:
+    """One decoded dump: magic, record size, contiguous record array and the record layout."""
+
+    def __init__(self, magic, rec_size, data):
+        self.magic = magic.decode()
+        self.rec_size = rec_size
+        self.data = bytes(data)
+        fmt, self.fields = FORMATS[magic]
+        if struct.calcsize(fmt) != rec_size:
+            raise DumpError("%s record size %d, expected %d" % (self.magic, rec_size, struct.calcsize(fmt)))
+        self.fmt = fmt
+
+    def __len__(self):
+        return len(self.data) // self.rec_size
+
+    def records(self):
+        return [dict(zip(self.fields, rec)) for rec in struct.iter_unpack(self.fmt, self.data)]
+
+
+def find_header(buf):
+    """Offset of the first dump header: magic followed by its record size (the announce line names the magic too)."""
+    start = -1
+    for magic, (fmt, _) in FORMATS.items():
+        pos = buf.find(magic)
+        while pos >= 0 and (pos + 7 > len(buf) or buf[pos + 4] != struct.calcsize(fmt)):
+            pos = buf.find(magic, pos + 1)
+        if pos >= 0 and (start < 0 or pos < start):
+            start = pos
+    return start
+
+
+def decode(path):
+    """Memory maps a dump file and checks its framing; returns the Dump."""
+    with open(path, "rb") as f:
+        try:
+            buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        except ValueError:
+            raise DumpError("%s: empty file" % path)
+    with buf:
+        start = find_header(buf)
+        if start < 0:
+            raise DumpError("%s: no TLOG/SCAP header" % path)
+        magic = buf[start:start + 4]
+        rec_size = buf[start + 4]
+        count = buf[start + 5] | (buf[start + 6] << 8)
+        pos = start + 7
+        data = bytearray()
+        block = 0
+        while len(data) < count * rec_size:
+            if pos + 2 > len(buf) or buf[pos] != BLOCK_ID:
+                raise DumpError("%s: block %d missing" % (path, block))
+            n = buf[pos + 1]
+            end = pos + 2 + n * rec_size
+            if n == 0 or len(data) + n * rec_size > count * rec_size or end >= len(buf):
+                raise DumpError("%s: block %d truncated" % (path, block))
+            payload = buf[pos + 2:end]
+            checksum = 0
+            for byte in payload:
+                checksum ^= byte
+            if checksum != buf[end]:
+                raise DumpError("%s: block %d checksum" % (path, block))
+            data += payload
+            pos = end + 1
+            block += 1
+        if buf[pos:pos + 4] != TRAILER:
+            raise DumpError("%s: no trailer" % path)
+        return Dump(magic, rec_size, data)
+
+
+def encode(magic, rec_size, data):
+    """Dump framing of a record array (TLOG_Dump)."""
+    count = len(data) // rec_size
+    out = bytearray(magic + bytes((rec_size, count & 0xFF, count >> 8)))
+    for first in range(0, count, DUMP_BLOCK):
+        block = data[first * rec_size:(first + DUMP_BLOCK) * rec_size]
+        checksum = 0
+        for byte in block:
+            checksum ^= byte
+        out += bytes((BLOCK_ID, len(block) // rec_size)) + block + bytes((checksum,))
+    return bytes(out + TRAILER)
+
+
+def anchor(samples):
+    """Index of the first period with capture or replay running, 0 if there is none."""
+    for idx, sample in enumerate(samples):
+        if sample["flags"] & (FLAG_CAPTURE | FLAG_REPLAY):
+            return idx
+    return 0
+
+
+def compare(ref, cur, fields, tolerance):
+    """Per field: mismatches beyond tolerance, largest difference, first mismatching index."""
+    result = {}
+    for name, tol_key in fields:
+        tol = tolerance.get(tol_key, 0)
+        if tol < 0:
+            continue
+        diffs = [abs(a[name] - b[name]) for a, b in zip(ref, cur)]
+        bad = [idx for idx, d in enumerate(diffs) if d > tol]
+        result[name] = (len(bad), max(diffs, default=0), bad[0] if bad else None)
+    return result
+
+
+def align(ref, cur, tolerance):
+    """Aligned views of both traces: anchors, then the shift within ALIGN_SLACK with the fewest mismatches."""
+    base_ref, base_cur = anchor(ref), anchor(cur)
+    best = None
+    for shift in range(-ALIGN_SLACK, ALIGN_SLACK + 1):
+        r0, c0 = base_ref + max(shift, 0), base_cur + max(-shift, 0)
+        n = min(len(ref) - r0, len(cur) - c0)
+        if n <= 0:
+            continue
+        res = compare(ref[r0:r0 + n], cur[c0:c0 + n], COMPARE + TELEMETRY, tolerance)
+        score = (sum(bad for bad, _, _ in res.values()), abs(shift))
+        if best is None or score < best[0]:
+            best = (score, r0, c0, n)
+    if best is None:
+        raise DumpError("traces do not overlap")
+    return best[1:]
+
+
+def diff_traces(ref_dump, cur_dump, tolerance, out=sys.stdout):
+    """Prints the compare and telemetry trace diff; returns True when the traces match."""
+    for dump in (ref_dump, cur_dump):
+        if dump.magic != "TLOG":
+            raise DumpError("diff needs TLOG dumps (D0), got %s" % dump.magic)
+    ref, cur = ref_dump.records(), cur_dump.records()
+    r0, c0, n = align(ref, cur, tolerance)
+    ref, cur = ref[r0:r0 + n], cur[c0:c0 + n]
+    print("aligned: %d periods, reference from #%d, replay from #%d" % (n, r0, c0), file=out)
+    same = True
+    for title, fields in (("compare", COMPARE), ("telemetry", TELEMETRY)):
+        print("%s trace" % title, file=out)
+        for name, (bad, worst, first) in compare(ref, cur, fields, tolerance).items():
+            note = ""
+            if bad:
+                same = False
+                note = "first at +%d (tick %d): %d / %d" % (first, cur[first]["tick"], ref[first][name], cur[first][name])
+            print("  %-6s mismatches: %4d  max |d|: %5d  %s" % (name, bad, worst, note), file=out)
+    return same
+
+
+def build_capture(path):
+    """Capture records (SCAP_SaveState layout first) from a replay script."""
+    state = STATE_DEFAULT
+    records = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            head, _, rest = line.partition(" ")
+            if head == "state":
+                if records:
+                    raise DumpError("%s:%d: state must come first" % (path, lineno))
+                state = tuple(int(v) for v in rest.split())
+                if len(state) != len(STATE_FIELDS):
+                    raise DumpError("%s:%d: state needs %s" % (path, lineno, " ".join(STATE_FIELDS)))
+                continue
+            tick = int(head)
+            if records and tick < records[-1][0]:
+                raise DumpError("%s:%d: tick goes back" % (path, lineno))
+            for char in rest.strip() + "\r":
+                records.append((tick, SCAP_RX, ord(char)))
+    data = b"".join(struct.pack("<HBB", 0, SCAP_STATE, value) for value in state)
+    data += b"".join(struct.pack("<HBB", tick & 0xFFFF, d, v) for tick, d, v in records)
+    return encode(b"SCAP", 4, data)
+
+
+def cmd_decode(args):
+    dump = decode(args.dump)
+    records = dump.records()
+    print("%s: %d records of %d B" % (dump.magic, len(dump), dump.rec_size))
+    if dump.magic == "SCAP":
+        state = [r["data"] for r in records if r["dir"] == SCAP_STATE]
+        if len(state) == len(STATE_FIELDS):
+            print("start state: " + ", ".join("%s %d" % kv for kv in zip(STATE_FIELDS, state)))
+        rx = bytes(r["data"] for r in records if r["dir"] == SCAP_RX)
+        print("rx: %r" % rx.decode("ascii", "replace"))
+    elif records:
+        print("ticks %d..%d, capture periods %d, replay periods %d" % (
+            records[0]["tick"], records[-1]["tick"], sum(1 for r in records if r["flags"] & FLAG_CAPTURE),
+            sum(1 for r in records if r["flags"] & FLAG_REPLAY)))
+    if args.csv:
+        print(",".join(dump.fields))
+        for rec in records:
+            print(",".join(str(rec[name]) for name in dump.fields))
+    if args.raw:
+        with open(args.raw, "wb") as f:
+            f.write(dump.data)
+    return 0
+
+
+def cmd_diff(args):
+    same = diff_traces(decode(args.reference), decode(args.replay), vars(args))
+    print("ok" if same else "FAIL")
+    return 0 if same else 1
+
+
+def cmd_capture(args):
+    with open(args.out, "wb") as f:
+        f.write(build_capture(args.script))
+    return 0
+
+
+def cmd_replay(args):
+    failed = 0
+    for capture in args.captures:
+        reference = os.path.splitext(capture)[0] + ".tlog"
+        with tempfile.TemporaryDirectory() as tmp:
+            log = os.path.join(tmp, "replay.tlog")
+            run = subprocess.run([args.driver, capture, log], capture_output=True, text=True)
+            if run.returncode != 0:
+                print("%s: driver failed: %s" % (capture, run.stderr.strip()))
+                failed += 1
+                continue
+            if args.update:
+                with open(log, "rb") as src, open(reference, "wb") as dst:
+                    dst.write(src.read())
+                print("%s: reference updated" % reference)
+                continue
+            print("%s" % capture)
+            if not diff_traces(decode(reference), decode(log), vars(args)):
+                failed += 1
+    print("ok" if failed == 0 else "FAIL (%d)" % failed)
+    return 0 if failed == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="FRAM dump decoder and trace diff")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("decode", help="check and decode a TLOG/SCAP dump")
+    p.add_argument("dump")
+    p.add_argument("--csv", action="store_true", help="print every record")
+    p.add_argument("--raw", help="write the record array without framing")
+    p.set_defaults(run=cmd_decode)
+    for name, run in (("diff", cmd_diff), ("replay", cmd_replay)):
+        p = sub.add_parser(name)
+        p.add_argument("--ccr-tol", type=int, default=0, help="compare value tolerance (timer counts)")
+        p.add_argument("--fb-tol", type=int, default=-1, help="feedback tolerance (ADC counts), -1 ignores it")
+        p.set_defaults(run=run)
+        if name == "diff":
+            p.add_argument("reference", help="TLOG dump of the original session or a reference replay")
+            p.add_argument("replay", help="TLOG dump of the replay")
+        else:
+            p.add_argument("--driver", default="./SCD_replay_host", help="host replay driver")
+            p.add_argument("--update", action="store_true", help="write the references")
+            p.add_argument("captures", nargs="+", help="capture dumps; reference <name>.tlog next to each")
+    p = sub.add_parser("capture", help="build a capture dump from a replay script")
+    p.add_argument("script")
+    p.add_argument("out")
+    p.set_defaults(run=cmd_capture)
+    args = parser.parse_args()
+    try:
+        return args.run(args)
+    except (OSError, ValueError, DumpError) as err:
+        print("trace_diff: %s" % err, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())